@@ -3,7 +3,10 @@
  * @brief Implementation of low-level processor functions.
  */
 
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
 #include <intrin.h>  // __cpuid
+#include <vector>
 
 // Launcher headers
 #include "CPU.h"
@@ -40,3 +43,72 @@ bool CPU::Has3DNow()
 	return bit3DNow != 0;
 }
 
+/**
+ * @brief Checks if the processor supports SSE2 instructions.
+ * @return True if SSE2 instruction set is available, otherwise false.
+ */
+bool CPU::HasSSE2()
+{
+	int cpuInfo[4];
+	__cpuid( cpuInfo, 0x1 );
+
+	int bitSSE2 = cpuInfo[3] & (1 << 26);  // bit 26 in EDX register
+
+	return bitSSE2 != 0;
+}
+
+/**
+ * @brief Obtains number of physical processor cores.
+ * GetLogicalProcessorInformation is obtained at runtime because it's not available in Windows XP without SP3.
+ * @return Number of physical cores or number of logical processors if the topology is unknown.
+ */
+unsigned int CPU::GetCoreCount()
+{
+	typedef BOOL (WINAPI *TGetLogicalProcessorInformation)( PSYSTEM_LOGICAL_PROCESSOR_INFORMATION, PDWORD );
+
+	TGetLogicalProcessorInformation pGetLogicalProcessorInformation = (TGetLogicalProcessorInformation)
+	  GetProcAddress( GetModuleHandleA( "kernel32.dll" ), "GetLogicalProcessorInformation" );
+
+	if ( pGetLogicalProcessorInformation )
+	{
+		DWORD size = 0;
+		pGetLogicalProcessorInformation( NULL, &size );
+
+		if ( size > 0 && GetLastError() == ERROR_INSUFFICIENT_BUFFER )
+		{
+			std::vector<SYSTEM_LOGICAL_PROCESSOR_INFORMATION> info( size / sizeof (SYSTEM_LOGICAL_PROCESSOR_INFORMATION) );
+
+			if ( pGetLogicalProcessorInformation( &info[0], &size ) )
+			{
+				unsigned int coreCount = 0;
+
+				for ( size_t i = 0; i < info.size(); i++ )
+				{
+					if ( info[i].Relationship == RelationProcessorCore )
+					{
+						coreCount++;
+					}
+				}
+
+				if ( coreCount > 0 )
+				{
+					return coreCount;
+				}
+			}
+		}
+	}
+
+	return GetLogicalProcessorCount();
+}
+
+/**
+ * @brief Obtains number of logical processors available to the launcher.
+ * @return Number of logical processors. Always at least 1.
+ */
+unsigned int CPU::GetLogicalProcessorCount()
+{
+	SYSTEM_INFO info;
+	GetSystemInfo( &info );
+
+	return (info.dwNumberOfProcessors > 0) ? info.dwNumberOfProcessors : 1;
+}
@@ -9,5 +9,9 @@ namespace CPU
 {
 	bool IsAMD();
 	bool Has3DNow();
+	bool HasSSE2();
+
+	unsigned int GetCoreCount();
+	unsigned int GetLogicalProcessorCount();
 }
 
@@ -0,0 +1,160 @@
+/**
+ * @file
+ * @brief Implementation of monotonic high-resolution clock.
+ */
+
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+
+// Launcher headers
+#include "Clock.h"
+
+static long long g_frequency = 1;
+static long long g_startTicks = 0;
+
+/**
+ * @brief Initializes the clock.
+ * This function MUST be called before any other thread is created.
+ */
+void Clock::Init()
+{
+	LARGE_INTEGER frequency;
+	if ( QueryPerformanceFrequency( &frequency ) && frequency.QuadPart > 0 )
+	{
+		g_frequency = frequency.QuadPart;
+	}
+
+	g_startTicks = GetTicks();
+}
+
+/**
+ * @brief Returns the current value of the clock.
+ * This function can be called from any thread.
+ */
+long long Clock::GetTicks()
+{
+	LARGE_INTEGER counter;
+	QueryPerformanceCounter( &counter );
+
+	return counter.QuadPart;
+}
+
+/**
+ * @brief Returns number of ticks per second.
+ */
+long long Clock::GetFrequency()
+{
+	return g_frequency;
+}
+
+double Clock::TicksToSeconds( long long ticks )
+{
+	return static_cast<double>( ticks ) / g_frequency;
+}
+
+long long Clock::SecondsToTicks( double seconds )
+{
+	return static_cast<long long>( seconds * g_frequency );
+}
+
+/**
+ * @brief Converts clock value to seconds since the launcher was started.
+ */
+double Clock::GetUptime( long long ticks )
+{
+	return TicksToSeconds( ticks - g_startTicks );
+}
+
+#define FILETIME_UNITS_PER_SECOND 10000000ULL
+
+static unsigned long long GetFileTimeValue( const FILETIME & fileTime )
+{
+	return (static_cast<unsigned long long>( fileTime.dwHighDateTime ) << 32) | fileTime.dwLowDateTime;
+}
+
+WallClock::WallClock()
+: m_syncTicks(0),
+  m_syncTime(0),
+  m_timeOfDaySecond(0)
+{
+	m_timeOfDay[0] = '\0';
+
+	Sync();
+}
+
+/**
+ * @brief Pairs the current clock value with the current system time.
+ */
+void WallClock::Sync()
+{
+	FILETIME systemTime;
+	GetSystemTimeAsFileTime( &systemTime );
+
+	m_syncTicks = Clock::GetTicks();
+	m_syncTime = GetFileTimeValue( systemTime );
+}
+
+/**
+ * @brief Converts clock value to UTC system time.
+ * The conversion is synchronized with the system time at most once per second, so the clock drift doesn't accumulate.
+ * @param ticks The clock value.
+ * @return Number of 100-nanosecond intervals since January 1, 1601 (UTC). The same as FILETIME.
+ */
+unsigned long long WallClock::GetUTCTime( long long ticks )
+{
+	if ( ticks - m_syncTicks >= Clock::GetFrequency() )
+	{
+		Sync();
+	}
+
+	// the value can be older than the last synchronization
+	const long long elapsed = ticks - m_syncTicks;
+	const long long elapsedSeconds = elapsed / Clock::GetFrequency();
+	const long long elapsedRemainder = elapsed % Clock::GetFrequency();
+
+	const long long offset = (elapsedSeconds * static_cast<long long>( FILETIME_UNITS_PER_SECOND ))
+	                       + (elapsedRemainder * static_cast<long long>( FILETIME_UNITS_PER_SECOND ) / Clock::GetFrequency());
+
+	return m_syncTime + offset;
+}
+
+/**
+ * @brief Converts clock value to local time of day.
+ * The text is cached, so the conversion is done at most once per second.
+ * @param ticks The clock value.
+ * @return Time of day in "HH:MM:SS" format.
+ */
+const char *WallClock::GetLocalTimeOfDay( long long ticks )
+{
+	const unsigned long long utcTime = GetUTCTime( ticks );
+	const unsigned long long second = utcTime / FILETIME_UNITS_PER_SECOND;
+
+	if ( second != m_timeOfDaySecond )
+	{
+		FILETIME fileTime;
+		fileTime.dwLowDateTime = static_cast<DWORD>( utcTime );
+		fileTime.dwHighDateTime = static_cast<DWORD>( utcTime >> 32 );
+
+		FILETIME localFileTime;
+		SYSTEMTIME localTime;
+
+		if ( ! FileTimeToLocalFileTime( &fileTime, &localFileTime ) || ! FileTimeToSystemTime( &localFileTime, &localTime ) )
+		{
+			return m_timeOfDay;
+		}
+
+		m_timeOfDay[0] = '0' + (localTime.wHour / 10);
+		m_timeOfDay[1] = '0' + (localTime.wHour % 10);
+		m_timeOfDay[2] = ':';
+		m_timeOfDay[3] = '0' + (localTime.wMinute / 10);
+		m_timeOfDay[4] = '0' + (localTime.wMinute % 10);
+		m_timeOfDay[5] = ':';
+		m_timeOfDay[6] = '0' + (localTime.wSecond / 10);
+		m_timeOfDay[7] = '0' + (localTime.wSecond % 10);
+		m_timeOfDay[8] = '\0';
+
+		m_timeOfDaySecond = second;
+	}
+
+	return m_timeOfDay;
+}
@@ -0,0 +1,39 @@
+/**
+ * @file
+ * @brief Monotonic high-resolution clock.
+ */
+
+#pragma once
+
+namespace Clock
+{
+	void Init();
+
+	long long GetTicks();
+	long long GetFrequency();
+
+	double TicksToSeconds( long long ticks );
+	long long SecondsToTicks( double seconds );
+
+	double GetUptime( long long ticks );
+}
+
+/**
+ * @brief Converts clock values to wall-clock time.
+ * Each thread must use its own instance.
+ */
+class WallClock
+{
+	long long m_syncTicks;
+	unsigned long long m_syncTime;
+	unsigned long long m_timeOfDaySecond;
+	char m_timeOfDay[16];
+
+	void Sync();
+
+public:
+	WallClock();
+
+	unsigned long long GetUTCTime( long long ticks );
+	const char *GetLocalTimeOfDay( long long ticks );
+};
@@ -3,15 +3,232 @@
  * @brief Implementation of game engine listener.
  */
 
+#include <algorithm>
+
+// CryEngine headers
+#include "IGameFramework.h"
+
 // Launcher headers
 #include "EngineListener.h"
 #include "LauncherEnv.h"
 #include "TaskSystem.h"
+#include "WorkerPool.h"
+#include "Sampler.h"
+#include "HitchWatchdog.h"
 #include "Log.h"
+#include "Clock.h"
+
+/**
+ * @brief Provides post-update notifications from CryAction.
+ */
+class EngineListener::GameFrameworkListener : public IGameFrameworkListener
+{
+	EngineListener *m_pOwner;
+
+public:
+	GameFrameworkListener( EngineListener *pOwner )
+	: m_pOwner(pOwner)
+	{
+	}
+
+	// --- IGameFrameworkListener ---
+
+	void OnPostUpdate( float fDeltaTime ) override
+	{
+		m_pOwner->NotifyPostUpdate();
+	}
+
+	void OnSaveGame( ISaveGame *pSaveGame ) override
+	{
+	}
+
+	void OnLoadGame( ILoadGame *pLoadGame ) override
+	{
+	}
+
+	void OnLevelEnd( const char *nextLevel ) override
+	{
+	}
+
+	void OnActionEvent( const SActionEvent & event ) override
+	{
+	}
+};
+
+EngineListener::EngineListener()
+: m_frameListeners(),
+  m_isNotifying(false),
+  m_hasRemovedListeners(false),
+  m_pGameFrameworkListener(new GameFrameworkListener( this )),
+  m_pGameFramework(NULL),
+  m_frameStartTime(0),
+  m_frameTime(0),
+  m_frameID(0),
+  m_frameStats()
+{
+}
+
+EngineListener::~EngineListener()
+{
+	UnregisterGameFramework();
+
+	delete m_pGameFrameworkListener;
+}
+
+void EngineListener::NotifyPreUpdate()
+{
+	const long long currentTime = Clock::GetTicks();
+
+	if ( m_frameStartTime )
+	{
+		m_frameTime = static_cast<float>( Clock::TicksToSeconds( currentTime - m_frameStartTime ) );
+		m_frameStats.AddFrame( currentTime, currentTime - m_frameStartTime );
+	}
+
+	m_frameStartTime = currentTime;
+	m_frameID++;
+
+	// listeners added meanwhile are notified in the next frame
+	const size_t count = m_frameListeners.size();
+
+	m_isNotifying = true;
+
+	for ( size_t i = 0; i < count; i++ )
+	{
+		if ( ILauncherFrameListener *pListener = m_frameListeners[i] )
+		{
+			pListener->OnPreUpdate( m_frameTime, m_frameID );
+		}
+	}
+
+	m_isNotifying = false;
+
+	RemoveNullListeners();
+}
+
+void EngineListener::NotifyPostUpdate()
+{
+	const size_t count = m_frameListeners.size();
+
+	m_isNotifying = true;
+
+	for ( size_t i = 0; i < count; i++ )
+	{
+		if ( ILauncherFrameListener *pListener = m_frameListeners[i] )
+		{
+			pListener->OnPostUpdate( m_frameTime, m_frameID );
+		}
+	}
+
+	m_isNotifying = false;
+
+	RemoveNullListeners();
+
+	// the wait of the frame rate limiter is not a hitch
+	if ( gLauncher->pHitchWatchdog )
+	{
+		gLauncher->pHitchWatchdog->EndFrame();
+	}
+}
+
+void EngineListener::RemoveNullListeners()
+{
+	if ( m_hasRemovedListeners )
+	{
+		std::vector<ILauncherFrameListener*>::iterator newEnd;
+		newEnd = std::remove( m_frameListeners.begin(), m_frameListeners.end(), static_cast<ILauncherFrameListener*>( NULL ) );
+
+		m_frameListeners.erase( newEnd, m_frameListeners.end() );
+
+		m_hasRemovedListeners = false;
+	}
+}
+
+/**
+ * @brief Adds persistent frame listener.
+ * This function MUST be called only from main thread. It can be called from a frame listener.
+ * @param pListener The listener. It's not owned by the launcher.
+ * @return True if the listener was added, otherwise false if it's already registered.
+ */
+bool EngineListener::AddFrameListener( ILauncherFrameListener *pListener )
+{
+	if ( ! pListener || std::find( m_frameListeners.begin(), m_frameListeners.end(), pListener ) != m_frameListeners.end() )
+	{
+		return false;
+	}
+
+	m_frameListeners.push_back( pListener );
+
+	return true;
+}
+
+/**
+ * @brief Removes frame listener.
+ * This function MUST be called only from main thread. It can be called from a frame listener.
+ * @param pListener The listener.
+ * @return True if the listener was removed, otherwise false if it's not registered.
+ */
+bool EngineListener::RemoveFrameListener( ILauncherFrameListener *pListener )
+{
+	std::vector<ILauncherFrameListener*>::iterator it;
+	it = std::find( m_frameListeners.begin(), m_frameListeners.end(), pListener );
+
+	if ( ! pListener || it == m_frameListeners.end() )
+	{
+		return false;
+	}
+
+	if ( m_isNotifying )
+	{
+		// the vector is compacted once the notification is finished
+		(*it) = NULL;
+		m_hasRemovedListeners = true;
+	}
+	else
+	{
+		m_frameListeners.erase( it );
+	}
+
+	return true;
+}
+
+/**
+ * @brief Registers post-update notifications from CryAction.
+ * @param pGameFramework The game framework or NULL if it's not available.
+ */
+void EngineListener::RegisterGameFramework( IGameFramework *pGameFramework )
+{
+	UnregisterGameFramework();
+
+	if ( pGameFramework )
+	{
+		pGameFramework->RegisterListener( m_pGameFrameworkListener, "C1-Headless", FRAMEWORKLISTENERPRIORITY_DEFAULT );
+		m_pGameFramework = pGameFramework;
+	}
+}
+
+/**
+ * @brief Unregisters post-update notifications from CryAction.
+ * This function MUST be called before the engine shuts down.
+ */
+void EngineListener::UnregisterGameFramework()
+{
+	if ( m_pGameFramework )
+	{
+		m_pGameFramework->UnregisterListener( m_pGameFrameworkListener );
+		m_pGameFramework = NULL;
+	}
+}
 
 bool EngineListener::OnError( const char *szErrorString )
 {
 	gLauncher->pLog->LogToStdErr( "Error: %s", szErrorString );
+
+	if ( EngineLog *pEngineLog = gLauncher->pLog->GetEngineLog() )
+	{
+		pEngineLog->Flush();
+	}
+
 	// quit
 	return true;
 }
@@ -32,19 +249,53 @@ void EngineListener::OnInitProgress( const char *sProgressMsg )
 void EngineListener::OnInit( ISystem *pSystem )
 {
 	gLauncher->pSystem = pSystem;
+
+	if ( gLauncher->pTaskSystem )
+	{
+		gLauncher->pTaskSystem->RegisterConsoleCommands();
+	}
+
+	if ( gLauncher->pWorkerPool )
+	{
+		gLauncher->pWorkerPool->RegisterConsoleCommands();
+	}
+
+	if ( gLauncher->pSampler )
+	{
+		gLauncher->pSampler->RegisterConsoleCommands();
+	}
+
+	m_frameStats.Init();
 }
 
 void EngineListener::OnShutdown()
 {
 	gLauncher->pLog->LogToStdOut( "Quit" );
+
+	if ( EngineLog *pEngineLog = gLauncher->pLog->GetEngineLog() )
+	{
+		pEngineLog->Flush();
+	}
 }
 
 void EngineListener::OnUpdate()
 {
+	if ( gLauncher->pHitchWatchdog )
+	{
+		gLauncher->pHitchWatchdog->BeginFrame();
+	}
+
 	if ( gLauncher->pTaskSystem )
 	{
 		gLauncher->pTaskSystem->ExecuteWaitingTasks();
 	}
+
+	NotifyPreUpdate();
+
+	if ( EngineLog *pEngineLog = gLauncher->pLog->GetEngineLog() )
+	{
+		pEngineLog->Update();
+	}
 }
 
 void EngineListener::GetMemoryUsage( ICrySizer *pSizer )
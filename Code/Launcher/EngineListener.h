@@ -5,12 +5,61 @@
 
 #pragma once
 
+#include <vector>
+
 // CryEngine headers
 #include "ISystem.h"
 
+// Launcher headers
+#include "ILauncherFrameListener.h"
+#include "FrameStats.h"
+
+struct IGameFramework;
+
 class EngineListener : public ISystemUserCallback
 {
+	class GameFrameworkListener;
+
+	std::vector<ILauncherFrameListener*> m_frameListeners;
+	bool m_isNotifying;
+	bool m_hasRemovedListeners;
+
+	GameFrameworkListener *m_pGameFrameworkListener;
+	IGameFramework *m_pGameFramework;
+
+	long long m_frameStartTime;
+	float m_frameTime;
+	unsigned int m_frameID;
+
+	FrameStats m_frameStats;
+
+	// disable implicit copy constructor and copy assignment operator
+	EngineListener( const EngineListener & );
+	EngineListener & operator=( const EngineListener & );
+
+	void NotifyPreUpdate();
+	void NotifyPostUpdate();
+	void RemoveNullListeners();
+
 public:
+	EngineListener();
+	~EngineListener();
+
+	bool AddFrameListener( ILauncherFrameListener *pListener );
+	bool RemoveFrameListener( ILauncherFrameListener *pListener );
+
+	void RegisterGameFramework( IGameFramework *pGameFramework );
+	void UnregisterGameFramework();
+
+	unsigned int GetFrameID() const
+	{
+		return m_frameID;
+	}
+
+	const FrameStats & GetFrameStats() const
+	{
+		return m_frameStats;
+	}
 
 	// --- ISystemUserCallback ---
 	bool OnError( const char *szErrorString ) override;
@@ -22,4 +71,3 @@ public:
 	void OnUpdate() override;
 	void GetMemoryUsage( ICrySizer *pSizer ) override;
 };
-
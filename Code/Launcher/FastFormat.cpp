@@ -0,0 +1,226 @@
+/**
+ * @file
+ * @brief Implementation of fast formatting of numbers without format string parsing.
+ *
+ * The output is the same as the output of vsnprintf_ with equivalent format specifier. Integers are converted two
+ * digits at a time and 64-bit division is used only for values that don't fit into 32 bits. Fixed-point numbers are
+ * rounded like vsnprintf_ does it with one known difference: exact halfway cases that round up to the next whole
+ * number are formatted correctly here, e.g. 0.95 with precision 1 is "1.0", while vsnprintf_ misses the rollover and
+ * produces "0.10". Special and very large values are passed to snprintf_.
+ */
+
+#include <string.h>
+
+// Library headers
+#include "printf/printf.h"
+
+// Launcher headers
+#include "FastFormat.h"
+
+static const char DIGIT_PAIRS[] =
+  "00010203040506070809"
+  "10111213141516171819"
+  "20212223242526272829"
+  "30313233343536373839"
+  "40414243444546474849"
+  "50515253545556575859"
+  "60616263646566676869"
+  "70717273747576777879"
+  "80818283848586878889"
+  "90919293949596979899";
+
+static const double POW10[] = { 1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000, 1000000000 };
+
+// same as PRINTF_MAX_FLOAT
+static const double MAX_FIXED_VALUE = 1e9;
+
+/**
+ * @brief Converts unsigned integer to decimal digits.
+ * @param end End of the output buffer. The digits are written backwards.
+ * @return Pointer to the first digit.
+ */
+static char *ConvertDigits( char *end, unsigned long long value )
+{
+	char *p = end;
+
+	while ( value > 0xFFFFFFFF )
+	{
+		const unsigned int pair = static_cast<unsigned int>( value % 100 ) * 2;
+		value /= 100;
+
+		*--p = DIGIT_PAIRS[pair+1];
+		*--p = DIGIT_PAIRS[pair];
+	}
+
+	// 32-bit division is much faster on 32-bit platform
+	unsigned long value32 = static_cast<unsigned long>( value );
+
+	while ( value32 >= 100 )
+	{
+		const unsigned int pair = (value32 % 100) * 2;
+		value32 /= 100;
+
+		*--p = DIGIT_PAIRS[pair+1];
+		*--p = DIGIT_PAIRS[pair];
+	}
+
+	if ( value32 >= 10 )
+	{
+		const unsigned int pair = value32 * 2;
+
+		*--p = DIGIT_PAIRS[pair+1];
+		*--p = DIGIT_PAIRS[pair];
+	}
+	else
+	{
+		*--p = static_cast<char>( '0' + value32 );
+	}
+
+	return p;
+}
+
+/**
+ * @brief Writes number with optional sign and padding.
+ * Zero padding is inserted between the sign and the digits.
+ */
+static size_t WritePadded( char *dest, const char *digits, size_t length, bool isNegative, unsigned int width, char pad )
+{
+	const size_t totalLength = length + ((isNegative) ? 1 : 0);
+	const size_t padLength = (width > totalLength) ? width - totalLength : 0;
+
+	char *p = dest;
+
+	if ( pad == '0' )
+	{
+		if ( isNegative )
+		{
+			*p++ = '-';
+		}
+
+		memset( p, '0', padLength );
+		p += padLength;
+	}
+	else
+	{
+		memset( p, pad, padLength );
+		p += padLength;
+
+		if ( isNegative )
+		{
+			*p++ = '-';
+		}
+	}
+
+	memcpy( p, digits, length );
+	p += length;
+
+	return p - dest;
+}
+
+/**
+ * @brief Formats unsigned integer like "%u" or "%0<width>u".
+ * @param dest Output buffer with space for at least max(width, MAX_INT_LENGTH) characters. No null terminator is added.
+ * @param width Minimum number of characters.
+ * @param pad Padding character. Either space or zero.
+ * @return Number of written characters.
+ */
+size_t FastFormat::FormatUInt( char *dest, unsigned long long value, unsigned int width, char pad )
+{
+	char buffer[MAX_INT_LENGTH];
+	char *end = buffer + sizeof buffer;
+	char *begin = ConvertDigits( end, value );
+
+	return WritePadded( dest, begin, end - begin, false, width, pad );
+}
+
+/**
+ * @brief Formats signed integer like "%d" or "%0<width>d".
+ * @param dest Output buffer with space for at least max(width, MAX_INT_LENGTH) characters. No null terminator is added.
+ * @param width Minimum number of characters including the sign.
+ * @param pad Padding character. Either space or zero.
+ * @return Number of written characters.
+ */
+size_t FastFormat::FormatInt( char *dest, long long value, unsigned int width, char pad )
+{
+	const bool isNegative = (value < 0);
+
+	// negation of the minimal value works only in unsigned arithmetic
+	const unsigned long long absValue = (isNegative) ? 0 - static_cast<unsigned long long>( value ) : value;
+
+	char buffer[MAX_INT_LENGTH];
+	char *end = buffer + sizeof buffer;
+	char *begin = ConvertDigits( end, absValue );
+
+	return WritePadded( dest, begin, end - begin, isNegative, width, pad );
+}
+
+/**
+ * @brief Formats floating-point number like "%<width>.<precision>f".
+ * @param dest Output buffer with space for at least max(width, MAX_FIXED_LENGTH) + 1 characters. No null terminator is
+ * added unless the value is passed to snprintf_.
+ * @param precision Number of digits after the decimal point. At most MAX_PRECISION.
+ * @param width Minimum number of characters.
+ * @return Number of written characters.
+ */
+size_t FastFormat::FormatFixed( char *dest, double value, unsigned int precision, unsigned int width )
+{
+	// NaN, infinity, very large values and unsupported precision
+	if ( ! (value <= MAX_FIXED_VALUE && value >= -MAX_FIXED_VALUE) || precision > MAX_PRECISION )
+	{
+		const size_t maxLength = ((width > MAX_FIXED_LENGTH) ? width : MAX_FIXED_LENGTH) + 1;
+		const int length = snprintf_( dest, maxLength, "%*.*f", width, precision, value );
+
+		return (length > 0) ? length : 0;
+	}
+
+	const bool isNegative = (value < 0);
+	if ( isNegative )
+	{
+		value = 0 - value;
+	}
+
+	unsigned long whole = static_cast<unsigned long>( value );
+	const double scaledFrac = (value - whole) * POW10[precision];
+	unsigned long frac = static_cast<unsigned long>( scaledFrac );
+	const double diff = scaledFrac - frac;
+
+	// same rounding of halfway cases as vsnprintf_, see below for zero precision
+	if ( diff > 0.5 || (diff == 0.5 && precision > 0 && (frac == 0 || (frac & 1))) )
+	{
+		++frac;
+
+		// handle rollover, e.g. 0.99 with precision 1 is 1.0
+		if ( frac >= POW10[precision] )
+		{
+			frac = 0;
+			++whole;
+		}
+	}
+
+	char buffer[MAX_FIXED_LENGTH];
+	char *end = buffer + sizeof buffer;
+	char *begin = end;
+
+	if ( precision == 0 )
+	{
+		if ( value - whole >= 0.5 && (whole & 1) )
+		{
+			// exactly 0.5 and odd, then round up
+			++whole;
+		}
+	}
+	else
+	{
+		char *fracBegin = ConvertDigits( end, frac );
+
+		// leading zeros of the fractional part
+		begin = end - precision;
+		memset( begin, '0', fracBegin - begin );
+
+		*--begin = '.';
+	}
+
+	begin = ConvertDigits( begin, whole );
+
+	return WritePadded( dest, begin, end - begin, isNegative, width, ' ' );
+}
@@ -0,0 +1,22 @@
+/**
+ * @file
+ * @brief Fast formatting of numbers without format string parsing.
+ */
+
+#pragma once
+
+#include <stddef.h>
+
+namespace FastFormat
+{
+	// maximum length of formatted number without width padding
+	const size_t MAX_INT_LENGTH = 20;    // "-9223372036854775808" or "18446744073709551615"
+	const size_t MAX_FIXED_LENGTH = 32;  // PRINTF_FTOA_BUFFER_SIZE
+
+	// maximum precision of fixed-point numbers
+	const unsigned int MAX_PRECISION = 9;
+
+	size_t FormatUInt( char *dest, unsigned long long value, unsigned int width, char pad );
+	size_t FormatInt( char *dest, long long value, unsigned int width, char pad );
+	size_t FormatFixed( char *dest, double value, unsigned int precision, unsigned int width );
+}
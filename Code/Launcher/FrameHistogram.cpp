@@ -0,0 +1,133 @@
+/**
+ * @file
+ * @brief Implementation of histogram of frame times.
+ *
+ * Index of a bucket consists of the power of two range and the top 7 bits of the value, so buckets of the lowest range
+ * map directly to values and each higher range reuses only the upper half of its sub-buckets.
+ */
+
+#include <string.h>
+
+// Launcher headers
+#include "FrameHistogram.h"
+
+FrameHistogram::FrameHistogram()
+{
+	Reset();
+}
+
+unsigned int FrameHistogram::GetBucketIndex( unsigned int value )  // static function
+{
+	unsigned int range = 0;
+
+	while ( (value >> range) >= FRAME_HISTOGRAM_SUB_BUCKET_COUNT )
+	{
+		range++;
+	}
+
+	return (range * FRAME_HISTOGRAM_SUB_BUCKET_HALF) + (value >> range);
+}
+
+/**
+ * @return The highest value counted in the specified bucket.
+ */
+unsigned int FrameHistogram::GetHighestValue( unsigned int index )  // static function
+{
+	if ( index < FRAME_HISTOGRAM_SUB_BUCKET_COUNT )
+	{
+		return index;
+	}
+
+	const unsigned int range = (index / FRAME_HISTOGRAM_SUB_BUCKET_HALF) - 1;
+	const unsigned int subBucket = index - (range * FRAME_HISTOGRAM_SUB_BUCKET_HALF);
+
+	return ((subBucket + 1) << range) - 1;
+}
+
+void FrameHistogram::Reset()
+{
+	memset( m_counts, 0, sizeof m_counts );
+	m_totalCount = 0;
+	m_maxValue = 0;
+	m_sum = 0;
+}
+
+/**
+ * @param value Value in microseconds. Values above about 67 seconds are clamped.
+ */
+void FrameHistogram::Add( unsigned int value )
+{
+	if ( value > FRAME_HISTOGRAM_MAX_VALUE )
+	{
+		value = FRAME_HISTOGRAM_MAX_VALUE;
+	}
+
+	m_counts[GetBucketIndex( value )]++;
+	m_totalCount++;
+	m_sum += value;
+
+	if ( value > m_maxValue )
+	{
+		m_maxValue = value;
+	}
+}
+
+/**
+ * @param percentile Percentile from 0 to 100.
+ * @return The highest value of the bucket containing the percentile, but never more than the maximum value.
+ */
+unsigned int FrameHistogram::GetValueAtPercentile( double percentile ) const
+{
+	if ( m_totalCount == 0 )
+	{
+		return 0;
+	}
+
+	if ( percentile >= 100 )
+	{
+		return m_maxValue;
+	}
+
+	unsigned int targetCount = static_cast<unsigned int>( (percentile / 100) * m_totalCount + 0.5 );
+	if ( targetCount < 1 )
+	{
+		targetCount = 1;
+	}
+
+	unsigned int count = 0;
+
+	for ( unsigned int i = 0; i < FRAME_HISTOGRAM_BUCKET_COUNT; i++ )
+	{
+		count += m_counts[i];
+
+		if ( count >= targetCount )
+		{
+			const unsigned int value = GetHighestValue( i );
+
+			return (value < m_maxValue) ? value : m_maxValue;
+		}
+	}
+
+	return m_maxValue;
+}
+
+/**
+ * @brief Counts values above the specified one.
+ * Values in the same bucket as the specified one are not counted.
+ */
+unsigned int FrameHistogram::GetCountAbove( unsigned int value ) const
+{
+	if ( value >= FRAME_HISTOGRAM_MAX_VALUE )
+	{
+		return 0;
+	}
+
+	unsigned int count = 0;
+
+	for ( unsigned int i = GetBucketIndex( value ) + 1; i < FRAME_HISTOGRAM_BUCKET_COUNT; i++ )
+	{
+		count += m_counts[i];
+	}
+
+	return count;
+}
@@ -0,0 +1,279 @@
+/**
+ * @file
+ * @brief Implementation of frame time statistics.
+ *
+ * Frame time is the time between the beginnings of two consecutive frames, so it includes waiting of the frame limiter.
+ * The optional stats file enabled by -framestats command line parameter gets one JSON object per line with
+ * statistics of the last interval. It's never truncated, so it can be simply followed by monitoring tools.
+ */
+
+#include <string.h>
+#include <string>
+
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+
+// CryEngine headers
+#include "ISystem.h"
+#include "IConsole.h"
+
+// Launcher headers
+#include "FrameStats.h"
+#include "LauncherEnv.h"
+#include "CmdLine.h"
+#include "Clock.h"
+#include "StringBuffer.h"
+
+// frames longer than these times in milliseconds are counted as hitches
+static const unsigned int HITCH_THRESHOLDS[FRAME_STATS_HITCH_THRESHOLD_COUNT] = { 50, 100, 250, 1000 };
+
+// the only instance is used by the console command
+static FrameStats *g_pFrameStats;
+
+typedef StringBuffer<512> FrameStatsBuffer;
+
+static unsigned int ToMicroseconds( double seconds )
+{
+	const double value = seconds * 1000000;
+
+	return (value < FRAME_HISTOGRAM_MAX_VALUE) ? static_cast<unsigned int>( value ) : FRAME_HISTOGRAM_MAX_VALUE;
+}
+
+static double ToMilliseconds( unsigned int microseconds )
+{
+	return microseconds / 1000.0;
+}
+
+static void AddWallTime( FrameStatsBuffer & buffer )
+{
+	SYSTEMTIME time;
+	GetSystemTime( &time );
+
+	buffer.append( '\"' );
+	buffer.append_uint<4, '0'>( time.wYear );
+	buffer.append( '-' );
+	buffer.append_uint<2, '0'>( time.wMonth );
+	buffer.append( '-' );
+	buffer.append_uint<2, '0'>( time.wDay );
+	buffer.append( 'T' );
+	buffer.append_uint<2, '0'>( time.wHour );
+	buffer.append( ':' );
+	buffer.append_uint<2, '0'>( time.wMinute );
+	buffer.append( ':' );
+	buffer.append_uint<2, '0'>( time.wSecond );
+	buffer.append( '.' );
+	buffer.append_uint<3, '0'>( time.wMilliseconds );
+	buffer.append( "Z\"" );
+}
+
+static void AddJsonMilliseconds( FrameStatsBuffer & buffer, const char *name, unsigned int microseconds )
+{
+	buffer.append( ",\"" );
+	buffer.append( name );
+	buffer.append( "\":" );
+	buffer.append_fixed<3, 0>( ToMilliseconds( microseconds ) );
+}
+
+FrameStats::FrameStats()
+: m_histogram(),
+  m_intervalHistogram(),
+  m_hFile(NULL),
+  m_pIntervalCVar(NULL),
+  m_intervalStartTime(0)
+{
+	memset( m_hitchCounts, 0, sizeof m_hitchCounts );
+	memset( m_intervalHitchCounts, 0, sizeof m_intervalHitchCounts );
+
+	g_pFrameStats = this;
+}
+
+FrameStats::~FrameStats()
+{
+	if ( m_hFile )
+	{
+		CloseHandle( m_hFile );
+	}
+
+	g_pFrameStats = NULL;
+}
+
+bool FrameStats::OpenFile( const char *fileName )
+{
+	std::string filePath = gLauncher->rootFolder;
+	filePath += '\\';
+	filePath += fileName;
+
+	HANDLE hFile = CreateFileA( filePath.c_str(), GENERIC_WRITE, FILE_SHARE_READ,
+	                            NULL, OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL );
+	if ( hFile == INVALID_HANDLE_VALUE )
+	{
+		CryLogAlways( "$4[Error] Unable to open frame stats file '%s': error code %lu", filePath.c_str(), GetLastError() );
+		return false;
+	}
+
+	SetFilePointer( hFile, 0, NULL, FILE_END );
+
+	m_hFile = hFile;
+
+	return true;
+}
+
+/**
+ * @brief Writes statistics of the last interval to the stats file and starts a new interval.
+ */
+void FrameStats::WriteToFile( long long currentTime )
+{
+	const FrameHistogram & histogram = m_intervalHistogram;
+
+	FrameStatsBuffer buffer;
+
+	buffer.append( "{\"time\":" );
+	AddWallTime( buffer );
+	buffer.append( ",\"uptime\":" );
+	buffer.append_fixed<3, 0>( Clock::GetUptime( currentTime ) );
+	buffer.append( ",\"interval\":" );
+	buffer.append_fixed<3, 0>( Clock::TicksToSeconds( currentTime - m_intervalStartTime ) );
+	buffer.append( ",\"frames\":" );
+	buffer.append_uint( histogram.GetCount() );
+	buffer.append( ",\"mean\":" );
+	buffer.append_fixed<3, 0>( histogram.GetMean() / 1000 );
+	AddJsonMilliseconds( buffer, "p50", histogram.GetValueAtPercentile( 50 ) );
+	AddJsonMilliseconds( buffer, "p90", histogram.GetValueAtPercentile( 90 ) );
+	AddJsonMilliseconds( buffer, "p99", histogram.GetValueAtPercentile( 99 ) );
+	AddJsonMilliseconds( buffer, "p999", histogram.GetValueAtPercentile( 99.9 ) );
+	AddJsonMilliseconds( buffer, "max", histogram.GetMax() );
+	buffer.append( ",\"hitches\":{" );
+
+	for ( int i = 0; i < FRAME_STATS_HITCH_THRESHOLD_COUNT; i++ )
+	{
+		if ( i > 0 )
+		{
+			buffer.append( ',' );
+		}
+
+		buffer.append( '\"' );
+		buffer.append_uint( HITCH_THRESHOLDS[i] );
+		buffer.append( "ms\":" );
+		buffer.append_uint( m_intervalHitchCounts[i] );
+	}
+
+	buffer.append( "}}\n" );
+
+	// only one short line per interval, so it's written directly
+	DWORD bytesWritten;
+	WriteFile( m_hFile, buffer.get(), static_cast<DWORD>( buffer.getLength() ), &bytesWritten, NULL );
+
+	m_intervalHistogram.Reset();
+	memset( m_intervalHitchCounts, 0, sizeof m_intervalHitchCounts );
+	m_intervalStartTime = currentTime;
+}
+
+void FrameStats::OnFrameStatsCmd( IConsoleCmdArgs *pArgs )  // static function
+{
+	FrameStats *self = g_pFrameStats;
+
+	if ( pArgs->GetArgCount() > 1 && strcmp( pArgs->GetArg( 1 ), "reset" ) == 0 )
+	{
+		self->Reset();
+		CryLogAlways( "Frame statistics reset" );
+		return;
+	}
+
+	const FrameHistogram & histogram = self->m_histogram;
+
+	CryLogAlways( "$3Frame time: frames = %u | mean = %.3f ms", histogram.GetCount(), histogram.GetMean() / 1000 );
+
+	CryLogAlways( "p50 = %.3f ms | p90 = %.3f ms | p99 = %.3f ms | p99.9 = %.3f ms | max = %.3f ms",
+	  ToMilliseconds( histogram.GetValueAtPercentile( 50 ) ),
+	  ToMilliseconds( histogram.GetValueAtPercentile( 90 ) ),
+	  ToMilliseconds( histogram.GetValueAtPercentile( 99 ) ),
+	  ToMilliseconds( histogram.GetValueAtPercentile( 99.9 ) ),
+	  ToMilliseconds( histogram.GetMax() ) );
+
+	for ( int i = 0; i < FRAME_STATS_HITCH_THRESHOLD_COUNT; i++ )
+	{
+		CryLogAlways( "Hitches > %4u ms | %u", HITCH_THRESHOLDS[i], self->m_hitchCounts[i] );
+	}
+}
+
+/**
+ * @brief Registers the console command and opens the stats file.
+ * This function MUST be called once the engine console is available.
+ */
+void FrameStats::Init()
+{
+	IConsole *pConsole = gLauncher->pSystem->GetIConsole();
+
+	m_pIntervalCVar = pConsole->RegisterFloat( "launcher_FrameStatsInterval", 60, VF_NOT_NET_SYNCED,
+	  "Time in seconds between writes to the frame stats file enabled by -framestats command line parameter.\n"
+	  "Usage: launcher_FrameStatsInterval [seconds]\n"
+	  "Default is 60 seconds."
+	);
+
+	pConsole->AddCommand( "launcher_framestats", OnFrameStatsCmd, 0,
+	  "Shows percentiles of server frame time and number of hitches.\n"
+	  "Usage: launcher_framestats [reset]"
+	);
+
+	std::string fileName = CmdLine::GetArgValue( "-framestats" );
+	if ( ! fileName.empty() )
+	{
+		OpenFile( fileName.c_str() );
+	}
+}
+
+void FrameStats::Reset()
+{
+	m_histogram.Reset();
+	memset( m_hitchCounts, 0, sizeof m_hitchCounts );
+}
+
+/**
+ * @param frameEndTime Clock value at the end of the frame.
+ * @param frameDuration Duration of the frame in clock ticks.
+ */
+void FrameStats::AddFrame( long long frameEndTime, long long frameDuration )
+{
+	const unsigned int value = ToMicroseconds( Clock::TicksToSeconds( frameDuration ) );
+
+	m_histogram.Add( value );
+	m_intervalHistogram.Add( value );
+
+	for ( int i = 0; i < FRAME_STATS_HITCH_THRESHOLD_COUNT && value > HITCH_THRESHOLDS[i] * 1000; i++ )
+	{
+		m_hitchCounts[i]++;
+		m_intervalHitchCounts[i]++;
+	}
+
+	if ( m_intervalStartTime == 0 )
+	{
+		m_intervalStartTime = frameEndTime;
+	}
+	else if ( m_hFile && m_pIntervalCVar )
+	{
+		const float interval = m_pIntervalCVar->GetFVal();
+
+		if ( interval > 0 && frameEndTime - m_intervalStartTime >= Clock::SecondsToTicks( interval ) )
+		{
+			WriteToFile( frameEndTime );
+		}
+	}
+}
+
+/**
+ * @param percentile Percentile from 0 to 100.
+ * @return Frame time in seconds.
+ */
+double FrameStats::GetPercentile( double percentile ) const
+{
+	return m_histogram.GetValueAtPercentile( percentile ) / 1000000.0;
+}
+
+/**
+ * @param frameTime Frame time in seconds.
+ * @return Number of frames longer than the specified time.
+ */
+unsigned int FrameStats::GetCountAbove( double frameTime ) const
+{
+	return m_histogram.GetCountAbove( ToMicroseconds( frameTime ) );
+}
@@ -0,0 +1,57 @@
+/**
+ * @file
+ * @brief Frame time statistics.
+ */
+
+#pragma once
+
+// Launcher headers
+#include "FrameHistogram.h"
+
+#define FRAME_STATS_HITCH_THRESHOLD_COUNT 4
+
+struct ICVar;
+struct IConsoleCmdArgs;
+
+/**
+ * @brief Collects durations of server frames.
+ * All functions must be called only from main thread.
+ */
+class FrameStats
+{
+	FrameHistogram m_histogram;          //!< Frames since start or reset.
+	FrameHistogram m_intervalHistogram;  //!< Frames since the last write to the stats file.
+
+	unsigned int m_hitchCounts[FRAME_STATS_HITCH_THRESHOLD_COUNT];
+	unsigned int m_intervalHitchCounts[FRAME_STATS_HITCH_THRESHOLD_COUNT];
+
+	void *m_hFile;
+	ICVar *m_pIntervalCVar;
+	long long m_intervalStartTime;
+
+	// disable implicit copy constructor and copy assignment operator
+	FrameStats( const FrameStats & );
+	FrameStats & operator=( const FrameStats & );
+
+	bool OpenFile( const char *fileName );
+	void WriteToFile( long long currentTime );
+
+	static void OnFrameStatsCmd( IConsoleCmdArgs *pArgs );
+
+public:
+	FrameStats();
+	~FrameStats();
+
+	void Init();
+	void Reset();
+
+	void AddFrame( long long frameEndTime, long long frameDuration );
+
+	double GetPercentile( double percentile ) const;
+	unsigned int GetCountAbove( double frameTime ) const;
+
+	unsigned int GetCount() const
+	{
+		return m_histogram.GetCount();
+	}
+};
@@ -0,0 +1,358 @@
+/**
+ * @file
+ * @brief Implementation of watchdog of main thread hitches.
+ *
+ * Main thread increments the heartbeat counter at the beginning and at the end of each frame, so only the frame itself
+ * is measured and not the wait between frames. Level loading is not measured either. The watchdog thread checks the
+ * counter several times per second and once it doesn't change for longer than the threshold, stacks of main thread are
+ * captured in regular intervals using the sampling profiler. Stacks are resolved and reported only after all of them are captured
+ * or once the hitch is over, so symbol loading doesn't delay the captures.
+ *
+ * The report is written directly to the standard error writer, because log messages from other threads than main
+ * are handed over to main thread, which is stuck. Recent log lines are included if -logring is used.
+ */
+
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <string>
+
+// CryEngine headers
+#include "ISystem.h"
+#include "IConsole.h"
+#include "IGameFramework.h"
+#include "ILevelSystem.h"
+
+// Launcher headers
+#include "HitchWatchdog.h"
+#include "LauncherEnv.h"
+#include "Sampler.h"
+#include "Clock.h"
+#include "Log.h"
+
+// time in milliseconds between checks of the heartbeat
+#define WATCHDOG_CHECK_INTERVAL 50
+
+// number of captured stacks per hitch
+#define WATCHDOG_CAPTURE_COUNT 5
+
+// time in seconds between captured stacks
+#define WATCHDOG_CAPTURE_INTERVAL 0.25
+
+// number of recent log lines included in the report
+#define WATCHDOG_LOG_LINE_COUNT 20
+
+#define WATCHDOG_LOG_BUFFER_SIZE (WATCHDOG_LOG_LINE_COUNT * 512)
+
+// the only instance is used by the cvar callback
+static HitchWatchdog *g_pHitchWatchdog;
+
+static void AppendFormat( std::string & text, const char *format, ... )
+{
+	char buffer[256];
+
+	va_list args;
+	va_start( args, format );
+	const int length = vsnprintf( buffer, sizeof buffer, format, args );
+	va_end( args );
+
+	if ( length > 0 )
+	{
+		text.append( buffer, (length < static_cast<int>( sizeof buffer )) ? length : sizeof buffer - 1 );
+	}
+}
+
+struct HitchCapture
+{
+	void *frames[Sampler::MAX_FRAMES];
+	int frameCount;
+	double time;  //!< Seconds since the last heartbeat.
+};
+
+static void WriteReport( const HitchCapture *captures, int captureCount, long heartbeat )
+{
+	// the heartbeat is incremented twice per frame
+	const unsigned long frameID = (heartbeat + 1) / 2;
+
+	std::string report;
+
+	AppendFormat( report, "Hitch watchdog: main thread stuck in frame %lu\n", frameID );
+
+	for ( int i = 0; i < captureCount; i++ )
+	{
+		AppendFormat( report, "Stack %d of %d at %.2f s:\n", i + 1, captureCount, captures[i].time );
+
+		if ( captures[i].frameCount > 0 )
+		{
+			gLauncher->pSampler->FormatStack( captures[i].frames, captures[i].frameCount, report );
+		}
+		else
+		{
+			report += "  (capture failed)\n";
+		}
+	}
+
+	EngineLog *pEngineLog = gLauncher->pLog->GetEngineLog();
+
+	char logBuffer[WATCHDOG_LOG_BUFFER_SIZE];
+	const size_t logLength = (pEngineLog) ? pEngineLog->CopyLastLines( WATCHDOG_LOG_LINE_COUNT, logBuffer, sizeof logBuffer ) : 0;
+
+	if ( logLength > 0 )
+	{
+		report += "Recent log lines:\n";
+		report.append( logBuffer, logLength );
+	}
+	else
+	{
+		report += "No recent log lines (use -logring to keep them)\n";
+	}
+
+	gLauncher->pLog->WriteToStdErrNow( report.c_str(), report.length() );
+}
+
+/**
+ * @brief Suspends the watchdog while a level is being loaded.
+ * Loading takes much longer than the threshold, but it's not a hitch.
+ */
+class HitchWatchdog::LevelListener : public ILevelSystemListener
+{
+	HitchWatchdog *m_pOwner;
+
+public:
+	LevelListener( HitchWatchdog *pOwner )
+	: m_pOwner(pOwner)
+	{
+	}
+
+	// --- ILevelSystemListener ---
+
+	void OnLevelNotFound( const char *levelName ) override
+	{
+	}
+
+	void OnLoadingStart( ILevelInfo *pLevel ) override
+	{
+		InterlockedExchange( &m_pOwner->m_isLoading, 1 );
+	}
+
+	void OnLoadingComplete( ILevel *pLevel ) override
+	{
+		InterlockedExchange( &m_pOwner->m_isLoading, 0 );
+	}
+
+	void OnLoadingError( ILevelInfo *pLevel, const char *error ) override
+	{
+		InterlockedExchange( &m_pOwner->m_isLoading, 0 );
+	}
+
+	void OnLoadingProgress( ILevelInfo *pLevel, int progressAmount ) override
+	{
+	}
+};
+
+HitchWatchdog::HitchWatchdog()
+: m_heartbeat(0),
+  m_threshold(0),
+  m_isLoading(0),
+  m_pLevelListener(new LevelListener( this )),
+  m_pLevelSystem(NULL),
+  m_hThread(NULL),
+  m_hStopEvent(NULL)
+{
+}
+
+HitchWatchdog::~HitchWatchdog()
+{
+	Stop();
+
+	delete m_pLevelListener;
+}
+
+unsigned long __stdcall HitchWatchdog::ThreadRoutine( void *param )  // static function
+{
+	static_cast<HitchWatchdog*>( param )->ThreadLoop();
+
+	return 0;
+}
+
+void HitchWatchdog::ThreadLoop()
+{
+	HitchCapture captures[WATCHDOG_CAPTURE_COUNT];
+	int captureCount = 0;
+	bool isHitch = false;
+	bool isReported = false;
+
+	long lastHeartbeat = m_heartbeat;
+	long long lastHeartbeatTime = Clock::GetTicks();
+	long long nextCaptureTime = 0;
+
+	while ( WaitForSingleObject( m_hStopEvent, WATCHDOG_CHECK_INTERVAL ) == WAIT_TIMEOUT )
+	{
+		const long heartbeat = m_heartbeat;
+		const long long currentTime = Clock::GetTicks();
+
+		// only frames are measured, so waiting between frames and loading levels are skipped
+		const bool isInFrame = (heartbeat & 1) && ! m_isLoading;
+
+		if ( heartbeat != lastHeartbeat || ! isInFrame )
+		{
+			if ( isHitch )
+			{
+				if ( ! isReported )
+				{
+					WriteReport( captures, captureCount, lastHeartbeat );
+				}
+
+				char message[128];
+				const int length = sprintf( message, "Hitch watchdog: main thread resumed after %.2f s\n",
+				                            Clock::TicksToSeconds( currentTime - lastHeartbeatTime ) );
+
+				gLauncher->pLog->WriteToStdErrNow( message, length );
+
+				isHitch = false;
+			}
+
+			lastHeartbeat = heartbeat;
+			lastHeartbeatTime = currentTime;
+
+			continue;
+		}
+
+		const long threshold = m_threshold;
+
+		if ( threshold <= 0 )
+		{
+			continue;
+		}
+
+		const double stallTime = Clock::TicksToSeconds( currentTime - lastHeartbeatTime );
+
+		if ( ! isHitch )
+		{
+			if ( stallTime * 1000 < threshold )
+			{
+				continue;
+			}
+
+			isHitch = true;
+			isReported = false;
+			captureCount = 0;
+			nextCaptureTime = currentTime;
+		}
+
+		if ( captureCount < WATCHDOG_CAPTURE_COUNT && currentTime >= nextCaptureTime )
+		{
+			HitchCapture & capture = captures[captureCount++];
+			capture.frameCount = gLauncher->pSampler->CaptureMainThreadStack( capture.frames, Sampler::MAX_FRAMES );
+			capture.time = stallTime;
+
+			nextCaptureTime = currentTime + Clock::SecondsToTicks( WATCHDOG_CAPTURE_INTERVAL );
+
+			if ( captureCount == WATCHDOG_CAPTURE_COUNT )
+			{
+				// main thread may never recover
+				WriteReport( captures, captureCount, lastHeartbeat );
+				isReported = true;
+			}
+		}
+	}
+}
+
+void HitchWatchdog::OnThresholdChanged( ICVar *pCVar )  // static function
+{
+	if ( g_pHitchWatchdog )
+	{
+		const float threshold = pCVar->GetFVal();
+
+		InterlockedExchange( &g_pHitchWatchdog->m_threshold, (threshold > 0) ? static_cast<long>( threshold * 1000 ) : 0 );
+	}
+}
+
+/**
+ * @brief Registers the threshold cvar and starts the watchdog thread.
+ * This function MUST be called after the engine console is created.
+ * @param pGameFramework The game framework used to suspend the watchdog during level loading or NULL.
+ * @return True if the watchdog thread was started, otherwise false.
+ */
+bool HitchWatchdog::Start( IGameFramework *pGameFramework )
+{
+	if ( m_hThread )
+	{
+		return false;
+	}
+
+	m_pLevelSystem = (pGameFramework) ? pGameFramework->GetILevelSystem() : NULL;
+
+	if ( m_pLevelSystem )
+	{
+		m_pLevelSystem->AddListener( m_pLevelListener );
+	}
+
+	g_pHitchWatchdog = this;
+
+	IConsole *pConsole = gLauncher->pSystem->GetIConsole();
+
+	ICVar *pThresholdCVar = pConsole->RegisterFloat( "launcher_HitchThreshold", 2, VF_NOT_NET_SYNCED,
+	  "Frame time in seconds after which stacks of main thread are captured and written to standard error.\n"
+	  "Usage: launcher_HitchThreshold [seconds]\n"
+	  "  0 = Disabled. Default is 2 seconds.",
+	  OnThresholdChanged
+	);
+
+	if ( pThresholdCVar )
+	{
+		OnThresholdChanged( pThresholdCVar );
+	}
+
+	m_hStopEvent = CreateEvent( NULL, TRUE, FALSE, NULL );
+	if ( ! m_hStopEvent )
+	{
+		Stop();
+		return false;
+	}
+
+	m_hThread = CreateThread( NULL, 0, ThreadRoutine, this, 0, NULL );
+	if ( ! m_hThread )
+	{
+		Stop();
+		return false;
+	}
+
+	// the watchdog must run even when all cores are busy
+	SetThreadPriority( m_hThread, THREAD_PRIORITY_ABOVE_NORMAL );
+
+	return true;
+}
+
+/**
+ * @brief Stops the watchdog thread.
+ * This function MUST be called before the engine shuts down, so its shutdown is not reported as a hitch.
+ */
+void HitchWatchdog::Stop()
+{
+	if ( m_hThread )
+	{
+		SetEvent( m_hStopEvent );
+		WaitForSingleObject( m_hThread, INFINITE );
+		CloseHandle( m_hThread );
+		m_hThread = NULL;
+	}
+
+	if ( m_hStopEvent )
+	{
+		CloseHandle( m_hStopEvent );
+		m_hStopEvent = NULL;
+	}
+
+	if ( m_pLevelSystem )
+	{
+		m_pLevelSystem->RemoveListener( m_pLevelListener );
+		m_pLevelSystem = NULL;
+	}
+
+	if ( g_pHitchWatchdog == this )
+	{
+		g_pHitchWatchdog = NULL;
+	}
+}
@@ -0,0 +1,69 @@
+/**
+ * @file
+ * @brief Watchdog of main thread hitches.
+ */
+
+#pragma once
+
+struct ICVar;
+struct IGameFramework;
+struct ILevelSystem;
+
+/**
+ * @brief Captures stacks of main thread when a frame takes too long.
+ * Start and Stop must be called only from main thread.
+ */
+class HitchWatchdog
+{
+	class LevelListener;
+
+	volatile long m_heartbeat;  //!< Odd while main thread is inside a frame.
+	volatile long m_threshold;  //!< Milliseconds or 0 if disabled.
+	volatile long m_isLoading;  //!< Non-zero while a level is being loaded.
+
+	LevelListener *m_pLevelListener;
+	ILevelSystem *m_pLevelSystem;
+
+	void *m_hThread;
+	void *m_hStopEvent;
+
+	// disable implicit copy constructor and copy assignment operator
+	HitchWatchdog( const HitchWatchdog & );
+	HitchWatchdog & operator=( const HitchWatchdog & );
+
+	void ThreadLoop();
+
+	static unsigned long __stdcall ThreadRoutine( void *param );
+	static void OnThresholdChanged( ICVar *pCVar );
+
+public:
+	HitchWatchdog();
+	~HitchWatchdog();
+
+	bool Start( IGameFramework *pGameFramework );
+	void Stop();
+
+	/**
+	 * @brief Tells the watchdog that main thread started a new frame.
+	 * This function MUST be called only from main thread at the beginning of each frame.
+	 */
+	void BeginFrame()
+	{
+		// the only writer, so no atomic operation is needed
+		// the counter stays odd if the previous frame wasn't ended
+		m_heartbeat += (m_heartbeat & 1) ? 2 : 1;
+	}
+
+	/**
+	 * @brief Tells the watchdog that main thread finished the frame.
+	 * Time between frames, e.g. waiting of the frame rate limiter, isn't measured.
+	 * This function MUST be called only from main thread at the end of each frame.
+	 */
+	void EndFrame()
+	{
+		if ( m_heartbeat & 1 )
+		{
+			m_heartbeat++;
+		}
+	}
+};
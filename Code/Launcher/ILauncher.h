@@ -8,7 +8,9 @@
 #include <stddef.h>
 #include <stdarg.h>
 
-struct ILauncherTask;
+// Launcher headers
+#include "ILauncherTask.h"
+#include "ILauncherFrameListener.h"
 
 struct ILauncher
 {
@@ -40,5 +42,105 @@ struct ILauncher
 
 	virtual void LogToStdOutV( const char *format, va_list args, const char *prefix = NULL ) = 0;
 	virtual void LogToStdErrV( const char *format, va_list args, const char *prefix = NULL ) = 0;
+
+	// --- Launcher 1.2 ---
+
+	/**
+	 * @brief Adds new task with the specified priority to be executed in main thread.
+	 * Low priority tasks may be deferred to later frames if the frame task budget is exceeded.
+	 * This function can be called from any thread.
+	 * @param pTask The task allocated on heap using the "new" operator.
+	 * @param priority The task priority.
+	 */
+	virtual void DispatchTaskWithPriority( ILauncherTask *pTask, ELauncherTaskPriority priority ) = 0;
+
+	/**
+	 * @brief Copies recent log lines kept in memory.
+	 * The lines are kept only if the launcher was started with "-logring <lines>" command line parameter.
+	 * Only whole lines are copied. Each of them is terminated by a new line character. No null terminator is added.
+	 * This function can be called from any thread and it never blocks logging.
+	 * @param seq Sequence number of the first requested line. Lines are numbered from 1, so 0 means the oldest one.
+	 * @param buffer Output buffer.
+	 * @param bufferSize Size of the output buffer in bytes.
+	 * @param pFirstSeq Receives sequence number of the first copied line or 0 if nothing was copied. Can be NULL.
+	 * If it's greater than the requested one, some lines were lost.
+	 * @param pNextSeq Receives sequence number to be used in the next call. Can be NULL.
+	 * @return Number of bytes copied to the output buffer.
+	 */
+	virtual size_t CopyLogLines( unsigned long long seq, char *buffer, size_t bufferSize, unsigned long long *pFirstSeq,
+	                             unsigned long long *pNextSeq ) = 0;
+
+	/**
+	 * @brief Adds new job to be executed by a launcher worker thread.
+	 * Once the job is executed, its Run function is called in main thread and then the job is destroyed.
+	 * This function can be called from any thread including the worker threads.
+	 * @param pJob The job allocated on heap using the "new" operator.
+	 * @return True if the job was added, otherwise false and the caller still owns the job. This happens when worker
+	 * threads are disabled or the server is shutting down.
+	 */
+	virtual bool DispatchJob( ILauncherJob *pJob ) = 0;
+
+	/**
+	 * @brief Returns number of launcher worker threads.
+	 * @return Number of worker threads or 0 if they are disabled.
+	 */
+	virtual int GetWorkerCount() = 0;
+
+	/**
+	 * @brief Schedules task to be executed in main thread after some time.
+	 * Timers are checked once per frame, so the task is executed in the first frame after the delay elapses.
+	 * This function MUST be called only from main thread.
+	 * @param pTask The task allocated on heap using the "new" operator. It's destroyed after its last execution.
+	 * @param delay Time in milliseconds until the first execution.
+	 * @param interval Time in milliseconds between executions of periodic task or 0 to execute the task only once.
+	 * Missed executions of periodic task are skipped.
+	 * @return Handle of the timer or 0 if the task was not scheduled and the caller still owns it.
+	 */
+	virtual unsigned int DispatchDelayedTask( ILauncherTask *pTask, unsigned int delay, unsigned int interval ) = 0;
+
+	/**
+	 * @brief Cancels scheduled task and destroys it.
+	 * Periodic task can cancel itself. It's destroyed once it returns.
+	 * This function MUST be called only from main thread.
+	 * @param handle Handle of the timer returned by DispatchDelayedTask.
+	 * @return True if the task was cancelled, otherwise false if the handle is not valid or the task already finished.
+	 */
+	virtual bool CancelDelayedTask( unsigned int handle ) = 0;
+
+	/**
+	 * @brief Adds persistent listener notified at the beginning and at the end of each frame.
+	 * This is much cheaper than dispatching a new task every frame.
+	 * This function MUST be called only from main thread. It can be called from a frame listener.
+	 * @param pListener The listener. The launcher doesn't own it, so it must be removed before it's destroyed.
+	 * @return True if the listener was added, otherwise false if it's already registered.
+	 */
+	virtual bool AddFrameListener( ILauncherFrameListener *pListener ) = 0;
+
+	/**
+	 * @brief Removes frame listener.
+	 * This function MUST be called only from main thread. It can be called from a frame listener.
+	 * @param pListener The listener.
+	 * @return True if the listener was removed, otherwise false if it's not registered.
+	 */
+	virtual bool RemoveFrameListener( ILauncherFrameListener *pListener ) = 0;
+
+	/**
+	 * @brief Returns percentile of server frame time.
+	 * Frame time is measured from the beginning of a frame to the beginning of the next one. All frames since the
+	 * start of the server or since "launcher_framestats reset" console command are included. The relative error is
+	 * below 1.6 %.
+	 * This function MUST be called only from main thread.
+	 * @param percentile Percentile from 0 to 100. 100 returns the longest frame.
+	 * @return Frame time in seconds or 0 if no frames were measured yet.
+	 */
+	virtual double GetFrameTimePercentile( double percentile ) = 0;
+
+	/**
+	 * @brief Returns number of server frames longer than the specified time.
+	 * This function MUST be called only from main thread.
+	 * @param frameTime Frame time in seconds. Zero returns number of all measured frames.
+	 * @return Number of frames.
+	 */
+	virtual unsigned int GetFrameCountAbove( double frameTime ) = 0;
 };
 
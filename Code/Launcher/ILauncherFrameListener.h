@@ -0,0 +1,27 @@
+/**
+ * @file
+ * @brief Launcher frame listener interface.
+ */
+
+#pragma once
+
+struct ILauncherFrameListener
+{
+	virtual ~ILauncherFrameListener()
+	{
+	}
+
+	/**
+	 * @brief Called in main thread at the beginning of each frame before the engine is updated.
+	 * @param deltaTime Real time in seconds since the beginning of the previous frame.
+	 * @param frameID Number of the current frame.
+	 */
+	virtual void OnPreUpdate( float deltaTime, unsigned int frameID ) = 0;
+
+	/**
+	 * @brief Called in main thread at the end of each frame after the game is updated.
+	 * @param deltaTime The same value as in OnPreUpdate of the current frame.
+	 * @param frameID The same value as in OnPreUpdate of the current frame.
+	 */
+	virtual void OnPostUpdate( float deltaTime, unsigned int frameID ) = 0;
+};
@@ -5,6 +5,18 @@
 
 #pragma once
 
+/**
+ * @brief Priority of launcher task.
+ */
+enum ELauncherTaskPriority
+{
+	eLTP_High,    //!< Executed before any other tasks.
+	eLTP_Normal,  //!< Always executed in the next frame. This is the default priority.
+	eLTP_Low,     //!< Deferred to later frames if the frame task budget is exceeded.
+
+	eLTP_Count    //!< Must be last.
+};
+
 struct ILauncherTask
 {
 	virtual ~ILauncherTask()
@@ -14,3 +26,16 @@ struct ILauncherTask
 	virtual void Run() = 0;
 };
 
+/**
+ * @brief Job executed by a launcher worker thread.
+ * Once the job is executed, it's passed to main thread as a normal priority launcher task, so its Run function is
+ * called in main thread and then the job is destroyed. This is the place to hand over the results.
+ */
+struct ILauncherJob : public ILauncherTask
+{
+	/**
+	 * @brief Executes the job in a worker thread.
+	 * Engine functions MUST NOT be called here unless they are thread-safe.
+	 */
+	virtual void Execute() = 0;
+};
@@ -0,0 +1,245 @@
+/**
+ * @file
+ * @brief Implementation of low-power mode of idle server.
+ *
+ * Game channels are looked up by ID because CryAction doesn't provide any way to enumerate them. The last found
+ * remote channel is checked first, so the full scan is done only while the server is empty and at most once per
+ * second. Once the server is idle, the server network nub is checked every frame to notice connection attempts as
+ * soon as possible.
+ */
+
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+
+// CryEngine headers
+#include "ISystem.h"
+#include "IConsole.h"
+#include "INetwork.h"
+#include "IGameFramework.h"
+
+// Launcher headers
+#include "IdleMonitor.h"
+#include "LauncherEnv.h"
+#include "MainLoop.h"
+
+// time in seconds between checks of connected players while the server isn't idle
+#define IDLE_CHECK_INTERVAL 1.0f
+
+// game channel IDs are 16-bit
+#define IDLE_MAX_CHANNEL_ID 0xFFFF
+
+// the only instance is used by the cvar callback
+static IdleMonitor *g_pIdleMonitor;
+
+static bool IsRemoteChannel( INetChannel *pChannel )
+{
+	return pChannel && ! pChannel->IsLocal();
+}
+
+IdleMonitor::IdleMonitor()
+: m_pGameFramework(NULL),
+  m_pIdleRateCVar(NULL),
+  m_pIdleDelayCVar(NULL),
+  m_pEngineRateCVar(NULL),
+  m_savedEngineRate(0),
+  m_checkTime(0),
+  m_emptyTime(0),
+  m_lastChannelID(0),
+  m_isIdle(false),
+  m_isLoopRate(false)
+{
+}
+
+IdleMonitor::~IdleMonitor()
+{
+	Shutdown();
+}
+
+bool IdleMonitor::HasRemoteChannels()
+{
+	if ( m_lastChannelID && IsRemoteChannel( m_pGameFramework->GetNetChannel( m_lastChannelID ) ) )
+	{
+		return true;
+	}
+
+	for ( unsigned int id = 1; id <= IDLE_MAX_CHANNEL_ID; id++ )
+	{
+		if ( IsRemoteChannel( m_pGameFramework->GetNetChannel( static_cast<uint16>( id ) ) ) )
+		{
+			m_lastChannelID = static_cast<unsigned short>( id );
+			return true;
+		}
+	}
+
+	m_lastChannelID = 0;
+
+	return IsConnecting();
+}
+
+/**
+ * @return True if there is a connection attempt without any channel yet, otherwise false.
+ */
+bool IdleMonitor::IsConnecting()
+{
+	INetNub *pServerNub = m_pGameFramework->GetServerNetNub();
+
+	return pServerNub && pServerNub->IsConnecting();
+}
+
+void IdleMonitor::EnterIdle( float rate )
+{
+	m_isLoopRate = (gLauncher->pMainLoop != NULL);
+
+	if ( m_isLoopRate )
+	{
+		gLauncher->pMainLoop->SetRateOverride( rate );
+	}
+	else if ( m_pEngineRateCVar )
+	{
+		m_savedEngineRate = m_pEngineRateCVar->GetFVal();
+		m_pEngineRateCVar->Set( rate );
+	}
+
+	// give unused memory back to the system, it's paged in again on demand
+	SetProcessWorkingSetSize( GetCurrentProcess(), static_cast<SIZE_T>( -1 ), static_cast<SIZE_T>( -1 ) );
+
+	m_isIdle = true;
+
+	CryLogAlways( "$3[Launcher] Server is idle, frame rate lowered to %.1f", rate );
+}
+
+void IdleMonitor::LeaveIdle()
+{
+	if ( m_isLoopRate )
+	{
+		// the main loop may be already gone
+		if ( gLauncher->pMainLoop )
+		{
+			gLauncher->pMainLoop->SetRateOverride( 0 );
+		}
+	}
+	else if ( m_pEngineRateCVar )
+	{
+		m_pEngineRateCVar->Set( m_savedEngineRate );
+	}
+
+	m_isIdle = false;
+	m_emptyTime = 0;
+	m_checkTime = 0;
+
+	CryLogAlways( "$3[Launcher] Server is no longer idle" );
+}
+
+void IdleMonitor::OnIdleRateChanged( ICVar *pCVar )  // static function
+{
+	IdleMonitor *self = g_pIdleMonitor;
+
+	if ( self && self->m_isIdle )
+	{
+		self->LeaveIdle();
+
+		// apply the new rate immediately
+		if ( pCVar->GetFVal() > 0 )
+		{
+			self->EnterIdle( pCVar->GetFVal() );
+		}
+	}
+}
+
+/**
+ * @brief Registers console variables and starts monitoring.
+ * @param pGameFramework The game framework or NULL if it's not available.
+ */
+void IdleMonitor::Init( IGameFramework *pGameFramework )
+{
+	IConsole *pConsole = gLauncher->pSystem->GetIConsole();
+
+	g_pIdleMonitor = this;
+
+	m_pGameFramework = pGameFramework;
+	m_pEngineRateCVar = pConsole->GetCVar( "sv_DedicatedMaxRate" );
+
+	m_pIdleRateCVar = pConsole->RegisterFloat( "launcher_IdleRate", 0, VF_NOT_NET_SYNCED,
+	  "Server frame rate while no players are connected.\n"
+	  "The full frame rate is restored as soon as a connection attempt arrives.\n"
+	  "Usage: launcher_IdleRate [rate]\n"
+	  "  0 = Disabled (default).",
+	  OnIdleRateChanged
+	);
+
+	m_pIdleDelayCVar = pConsole->RegisterFloat( "launcher_IdleDelay", 60, VF_NOT_NET_SYNCED,
+	  "Time in seconds without any players before the server frame rate is lowered.\n"
+	  "Usage: launcher_IdleDelay [seconds]\n"
+	  "Default is 60 seconds."
+	);
+}
+
+/**
+ * @brief Restores the full frame rate.
+ * This function MUST be called before the engine shuts down.
+ */
+void IdleMonitor::Shutdown()
+{
+	if ( m_isIdle )
+	{
+		LeaveIdle();
+	}
+
+	m_pGameFramework = NULL;
+
+	if ( g_pIdleMonitor == this )
+	{
+		g_pIdleMonitor = NULL;
+	}
+}
+
+void IdleMonitor::OnPreUpdate( float deltaTime, unsigned int frameID )
+{
+	const float idleRate = (m_pIdleRateCVar) ? m_pIdleRateCVar->GetFVal() : 0;
+
+	if ( ! m_pGameFramework || idleRate <= 0 )
+	{
+		return;
+	}
+
+	m_checkTime += deltaTime;
+
+	if ( m_isIdle )
+	{
+		if ( IsConnecting() || (m_checkTime >= IDLE_CHECK_INTERVAL && HasRemoteChannels()) )
+		{
+			LeaveIdle();
+		}
+		else if ( m_checkTime >= IDLE_CHECK_INTERVAL )
+		{
+			m_checkTime = 0;
+		}
+
+		return;
+	}
+
+	if ( m_checkTime < IDLE_CHECK_INTERVAL )
+	{
+		return;
+	}
+
+	if ( HasRemoteChannels() )
+	{
+		m_emptyTime = 0;
+	}
+	else
+	{
+		m_emptyTime += m_checkTime;
+
+		if ( m_emptyTime >= m_pIdleDelayCVar->GetFVal() )
+		{
+			EnterIdle( idleRate );
+		}
+	}
+
+	m_checkTime = 0;
+}
+
+void IdleMonitor::OnPostUpdate( float deltaTime, unsigned int frameID )
+{
+}
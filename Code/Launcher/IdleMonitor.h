@@ -0,0 +1,61 @@
+/**
+ * @file
+ * @brief Low-power mode of idle server.
+ */
+
+#pragma once
+
+// Launcher headers
+#include "ILauncherFrameListener.h"
+
+struct IGameFramework;
+struct ICVar;
+struct IConsoleCmdArgs;
+
+/**
+ * @brief Lowers server frame rate while no players are connected.
+ * All functions must be called only from main thread.
+ */
+class IdleMonitor : public ILauncherFrameListener
+{
+	IGameFramework *m_pGameFramework;
+
+	ICVar *m_pIdleRateCVar;
+	ICVar *m_pIdleDelayCVar;
+	ICVar *m_pEngineRateCVar;
+
+	float m_savedEngineRate;
+	float m_checkTime;
+	float m_emptyTime;
+	unsigned short m_lastChannelID;
+	bool m_isIdle;
+	bool m_isLoopRate;  //!< The idle rate is applied to the launcher main loop instead of the engine.
+
+	// disable implicit copy constructor and copy assignment operator
+	IdleMonitor( const IdleMonitor & );
+	IdleMonitor & operator=( const IdleMonitor & );
+
+	bool HasRemoteChannels();
+	bool IsConnecting();
+
+	void EnterIdle( float rate );
+	void LeaveIdle();
+
+	static void OnIdleRateChanged( ICVar *pCVar );
+
+public:
+	IdleMonitor();
+	~IdleMonitor();
+
+	void Init( IGameFramework *pGameFramework );
+	void Shutdown();
+
+	bool IsIdle() const
+	{
+		return m_isIdle;
+	}
+
+	// --- ILauncherFrameListener ---
+	void OnPreUpdate( float deltaTime, unsigned int frameID ) override;
+	void OnPostUpdate( float deltaTime, unsigned int frameID ) override;
+};
@@ -7,8 +7,12 @@
 
 class Log;
 class TaskSystem;
+class WorkerPool;
 class Validator;
 class EngineListener;
+class MainLoop;
+class Sampler;
+class HitchWatchdog;
 
 struct ISystem;
 
@@ -16,8 +20,12 @@ struct LauncherEnv
 {
 	Log *pLog;
 	TaskSystem *pTaskSystem;
+	WorkerPool *pWorkerPool;
 	Validator *pValidator;
 	EngineListener *pEngineListener;
+	MainLoop *pMainLoop;  //!< Only if the launcher runs its own main loop.
+	Sampler *pSampler;
+	HitchWatchdog *pHitchWatchdog;  //!< Only while the server is running.
 
 	ISystem *pSystem;
 
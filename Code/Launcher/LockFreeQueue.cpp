@@ -0,0 +1,59 @@
+/**
+ * @file
+ * @brief Implementation of intrusive lock-free multi-producer single-consumer queue.
+ */
+
+#include <stddef.h>
+
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+
+// Launcher headers
+#include "LockFreeQueue.h"
+
+/**
+ * @brief Adds node to the queue.
+ * This function can be called from any thread.
+ * @param pNode The node. It must not be in any queue.
+ */
+void LockFreeQueue::Push( LockFreeQueueNode *pNode )
+{
+	LockFreeQueueNode *pHead;
+
+	do
+	{
+		pHead = m_pHead;
+		pNode->pNext = pHead;
+	}
+	while ( InterlockedCompareExchangePointer( reinterpret_cast<PVOID volatile*>( &m_pHead ), pNode, pHead ) != pHead );
+}
+
+/**
+ * @brief Removes all nodes from the queue using a single atomic exchange.
+ * The nodes are never removed one by one, so this function is not affected by the ABA problem.
+ * This function MUST be called only from one thread at a time.
+ * @return The oldest node linked to the newer ones in FIFO order, or NULL if the queue is empty.
+ */
+LockFreeQueueNode *LockFreeQueue::PopAll()
+{
+	if ( ! m_pHead )
+	{
+		return NULL;
+	}
+
+	LockFreeQueueNode *pNode = static_cast<LockFreeQueueNode*>(
+	  InterlockedExchangePointer( reinterpret_cast<PVOID volatile*>( &m_pHead ), NULL )
+	);
+
+	// the nodes are linked from the newest to the oldest, so reverse them
+	LockFreeQueueNode *pFirst = NULL;
+	while ( pNode )
+	{
+		LockFreeQueueNode *pNext = pNode->pNext;
+		pNode->pNext = pFirst;
+		pFirst = pNode;
+		pNode = pNext;
+	}
+
+	return pFirst;
+}
@@ -0,0 +1,42 @@
+/**
+ * @file
+ * @brief Intrusive lock-free multi-producer single-consumer queue.
+ */
+
+#pragma once
+
+#include <stddef.h>
+
+struct LockFreeQueueNode
+{
+	LockFreeQueueNode *pNext;
+
+	LockFreeQueueNode()
+	: pNext(NULL)
+	{
+	}
+};
+
+class LockFreeQueue
+{
+	LockFreeQueueNode * volatile m_pHead;  //!< The most recently pushed node.
+
+	// disable implicit copy constructor and copy assignment operator
+	LockFreeQueue( const LockFreeQueue & );
+	LockFreeQueue & operator=( const LockFreeQueue & );
+
+public:
+	LockFreeQueue()
+	: m_pHead(NULL)
+	{
+	}
+
+	bool IsEmpty() const
+	{
+		return m_pHead == NULL;
+	}
+
+	void Push( LockFreeQueueNode *pNode );
+
+	LockFreeQueueNode *PopAll();
+};
@@ -8,14 +8,15 @@
 #include <new>
 #include <string>
 #include <vector>
+#include <algorithm>
 
 #define WIN32_LEAN_AND_MEAN
 #include <windows.h>
+#include <winioctl.h>  // FSCTL_SET_COMPRESSION
 
 // CryEngine headers
 #include "ISystem.h"
 #include "IConsole.h"
-#include "ITimer.h"
 //#include "Cry_Geo.h"  // required by IRenderer.h
 //#include "IRenderer.h"
 
@@ -26,11 +27,31 @@
 #include "LauncherEnv.h"
 #include "TaskSystem.h"
 #include "CmdLine.h"
+#include "LogWriter.h"
+#include "LogRing.h"
+#include "LogArgs.h"
+#include "LogFloodFilter.h"
+#include "LogSanitizer.h"
+#include "Clock.h"
 
 #define LOG_DEFAULT_FILE_NAME "Server.log"
 #define LOG_DEFAULT_VERBOSITY 1
+#define LOG_ASYNC_QUEUE_SIZE (512 * 1024)
+#define LOG_DEFAULT_FLUSH_INTERVAL 0  // write-through, buffering is opt-in
+#define LOG_TASK_POOL_SIZE 512
+#define LOG_STD_QUEUE_SIZE (256 * 1024)
+#define LOG_STD_STOP_TIMEOUT 2000
+#define LOG_BACKUP_NAME_PREFIX "BackupNameAttachment="
 
 typedef StringBuffer<2048> LogBuffer;
+typedef StringBuffer<2560> JsonLogBuffer;
+
+// log task contains the buffer and only a few other members
+#define LOG_TASK_POOL_BLOCK_SIZE (sizeof (LogBuffer) + 64)
+
+// deferred log task contains captured arguments instead of the buffer
+#define LOG_DEFERRED_RECORD_SIZE 2048
+#define LOG_DEFERRED_PREFIX_SIZE 32
 
 namespace ELogFlags
 {
@@ -39,44 +60,163 @@ namespace ELogFlags
 		FILE    = (1 << 0),  //!< Log message to file.
 		CONSOLE = (1 << 1),  //!< Log message to console.
 
-		APPEND  = (1 << 2)   //!< Append message to the last line.
+		APPEND  = (1 << 2),  //!< Append message to the last line.
+		FLUSH   = (1 << 3)   //!< Write message to file without any delay.
 	};
 }
 
+/**
+ * @brief Information about log message captured when the message is logged.
+ */
+struct LogMessageInfo
+{
+	ILog::ELogType type;
+	unsigned long threadID;
+	long long time;  //!< Clock ticks.
+
+	LogMessageInfo()
+	: type(ILog::eMessage),
+	  threadID(),
+	  time()
+	{
+	}
+};
+
+/**
+ * @brief Base of tasks used to pass log messages from other threads to main thread.
+ * The tasks are allocated from a pool and recycled after being executed in main thread, so no heap is used.
+ */
+struct PooledLogTask : public ILauncherTask
+{
+	static void *operator new( size_t size )
+	{
+		return gLauncher->pLog->GetTaskPool().Alloc( size );
+	}
+
+	static void operator delete( void *p )
+	{
+		gLauncher->pLog->GetTaskPool().Free( p );
+	}
+};
+
+/**
+ * @brief Captures the format string and its arguments for formatting in main thread.
+ * @return True if the arguments were captured, otherwise false.
+ */
+static bool CaptureLogArgs( unsigned char (&record)[LOG_DEFERRED_RECORD_SIZE], const char *format, va_list args )
+{
+	va_list argsCopy;
+	va_copy( argsCopy, args );  // the arguments are still needed if capturing fails
+
+	const bool isCaptured = LogArgs::Capture( record, sizeof record, format, argsCopy ) > 0;
+
+	va_end( argsCopy );
+
+	gLauncher->pLog->OnDeferred( isCaptured );
+
+	return isCaptured;
+}
+
+static void AppendLogArgs( LogBuffer & buffer, const unsigned char *record )
+{
+	size_t length = LogArgs::Format( record, buffer.beginAppend( 0 ), buffer.getAvailableLength() + 1 );
+
+	if ( length > buffer.getAvailableLength() )
+	{
+		// the first attempt only measured the message
+		LogArgs::Format( record, buffer.beginAppend( length ), length + 1 );
+	}
+
+	buffer.endAppend( length );
+}
+
 class EngineLog::Impl
 {
 	ICVar *m_pLogVerbosityCVar;
 	ICVar *m_pLogFileVerbosityCVar;
 	ICVar *m_pLogIncludeTimeCVar;
-	CTimeValue m_includeTimeStartTime;
-	CTimeValue m_includeTimeLastTime;
+	ICVar *m_pLogAsyncCVar;
+	ICVar *m_pLogFlushIntervalCVar;
+	ICVar *m_pLogMaxSizeCVar;
+	ICVar *m_pLogRotateIntervalCVar;
+	ICVar *m_pLogMaxBackupsCVar;
+	ICVar *m_pLogCompressBackupsCVar;
+	ICVar *m_pLogFloodCollapseCVar;
+	ICVar *m_pLogFloodLimitCVar;
+	ICVar *m_pLogFloodBurstCVar;
+	long long m_includeTimeStartTime;
+	long long m_includeTimeLastTime;
+	WallClock m_wallClock;
 	HANDLE m_hLogFile;
+	uint64 m_logFileSize;
+	long long m_rotateTime;
+	std::string m_backupNameLine;
+	HANDLE m_hJsonFile;
+	LogWriter m_logWriter;
+	LogWriter m_jsonWriter;
+	LogRing m_logRing;
+	LogFloodFilter m_floodFilter;
+	bool m_isLastSuppressed;
 	std::string m_logFileName;
 	std::vector<ILogCallback*> m_callbacks;
 
-	void DoLog( const LogBuffer & buffer, int flags );
-	void WriteToLogFile( const LogBuffer & buffer, int flags );
+	int ApplyVerbosity( ILog::ELogType msgType, int flags ) const;
+
+	void DoLog( const LogBuffer & buffer, const LogMessageInfo & info, int flags );
+	void WriteMessage( const LogBuffer & buffer, const LogMessageInfo & info, int flags );
+	void WriteToLogFile( const LogBuffer & buffer, const LogMessageInfo & info, int flags );
+	void WriteToJsonFile( const char *text, size_t length, const LogMessageInfo & info, int flags );
 	void WriteToConsole( const LogBuffer & buffer, int flags );
 
+	bool OpenJsonFile( const char *fileName );
+	void UpdateRotation();
+	void RotateLogFile();
+	bool StartWriterThreads();
+	void StopWriterThreads();
+
 	static void OnIncludeTimeValueChanged( ICVar *pCVar );
+	static void OnAsyncValueChanged( ICVar *pCVar );
+	static void OnFlushIntervalValueChanged( ICVar *pCVar );
+	static void OnFloodValueChanged( ICVar *pCVar );
+	static void OnFloodReport( const LogFloodFilter::Report & report, void *param );
+	static void OnLogStatsCmd( IConsoleCmdArgs *pArgs );
 
-	struct LogTask : public ILauncherTask
+	struct LogTask : public PooledLogTask
 	{
 		Impl *pContext;
 		LogBuffer buffer;
+		LogMessageInfo info;
 		int flags;
 
 		LogTask( Impl *pThis )
 		: pContext(pThis),
 		  buffer(),
+		  info(),
 		  flags()
 		{
 		}
 
 		void Run() override
 		{
-			pContext->DoLog( buffer, flags );
+			pContext->DoLog( buffer, info, flags );
+		}
+	};
+
+	struct DeferredLogTask : public PooledLogTask
+	{
+		Impl *pContext;
+		LogMessageInfo info;
+		int flags;
+		unsigned char record[LOG_DEFERRED_RECORD_SIZE];
+
+		DeferredLogTask( Impl *pThis )
+		: pContext(pThis),
+		  info(),
+		  flags()
+		{
 		}
+
+		void Run() override;
 	};
 
 public:
@@ -84,9 +224,28 @@ public:
 	: m_pLogVerbosityCVar(NULL),
 	  m_pLogFileVerbosityCVar(NULL),
 	  m_pLogIncludeTimeCVar(NULL),
-	  m_includeTimeStartTime(),
-	  m_includeTimeLastTime(),
+	  m_pLogAsyncCVar(NULL),
+	  m_pLogFlushIntervalCVar(NULL),
+	  m_pLogMaxSizeCVar(NULL),
+	  m_pLogRotateIntervalCVar(NULL),
+	  m_pLogMaxBackupsCVar(NULL),
+	  m_pLogCompressBackupsCVar(NULL),
+	  m_pLogFloodCollapseCVar(NULL),
+	  m_pLogFloodLimitCVar(NULL),
+	  m_pLogFloodBurstCVar(NULL),
+	  m_includeTimeStartTime(Clock::GetTicks()),
+	  m_includeTimeLastTime(Clock::GetTicks()),
+	  m_wallClock(),
 	  m_hLogFile(NULL),
+	  m_logFileSize(0),
+	  m_rotateTime(0),
+	  m_backupNameLine(),
+	  m_hJsonFile(NULL),
+	  m_logWriter(),
+	  m_jsonWriter(),
+	  m_logRing(),
+	  m_floodFilter(),
+	  m_isLastSuppressed(false),
 	  m_logFileName(),
 	  m_callbacks()
 	{
@@ -94,11 +253,21 @@ public:
 
 	~Impl()
 	{
+		// write everything that is still queued
+		StopWriterThreads();
+		m_logWriter.SetFile( NULL );
+		m_jsonWriter.SetFile( NULL );
+
 		if ( m_hLogFile )
 		{
 			CloseHandle( m_hLogFile );
 		}
 
+		if ( m_hJsonFile )
+		{
+			CloseHandle( m_hJsonFile );
+		}
+
 		UnregisterConsoleVariables();
 	}
 
@@ -128,6 +297,39 @@ public:
 	void RegisterConsoleVariables();
 	void UnregisterConsoleVariables();
 
+	void Update()
+	{
+		if ( IsMainThread() )
+		{
+			m_floodFilter.Update( Clock::GetTicks(), OnFloodReport, this );
+
+			UpdateRotation();
+
+			m_logWriter.Update();
+			m_jsonWriter.Update();
+		}
+	}
+
+	void Flush()
+	{
+		if ( IsMainThread() )
+		{
+			m_logWriter.Flush();
+			m_jsonWriter.Flush();
+		}
+	}
+
+	size_t CopyRecentLines( unsigned long long seq, char *buffer, size_t bufferSize, unsigned long long *pFirstSeq,
+	                        unsigned long long *pNextSeq ) const
+	{
+		return m_logRing.Copy( seq, buffer, bufferSize, pFirstSeq, pNextSeq );
+	}
+
+	size_t CopyLastLines( size_t lineCount, char *buffer, size_t bufferSize ) const
+	{
+		return m_logRing.CopyLast( lineCount, buffer, bufferSize );
+	}
+
 	void AddCallback( ILogCallback *pCallback );
 	void RemoveCallback( ILogCallback *pCallback );
 
@@ -136,43 +338,61 @@ public:
 	void Log( ILog::ELogType msgType, const char *format, va_list args, int flags );
 };
 
-void EngineLog::Impl::DoLog( const LogBuffer & buffer, int flags )
+static bool IsFloodFilterExempt( ILog::ELogType msgType )
 {
-	if ( flags & ELogFlags::FILE )
+	// these are mostly responses to console commands, which can be long but must not be suppressed
+	return msgType == ILog::eAlways || msgType == ILog::eInput || msgType == ILog::eInputResponse;
+}
+
+void EngineLog::Impl::DoLog( const LogBuffer & buffer, const LogMessageInfo & info, int flags )
+{
+	if ( flags & ELogFlags::APPEND )
 	{
-		WriteToLogFile( buffer, flags );
+		if ( m_isLastSuppressed )
+		{
+			// don't append anything to a line that was not logged
+			return;
+		}
 	}
-
-	if ( flags & ELogFlags::CONSOLE )
+	else if ( ! IsFloodFilterExempt( info.type ) )
 	{
-		WriteToConsole( buffer, flags );
+		m_isLastSuppressed = ! m_floodFilter.Check( info.type, buffer.get(), buffer.getLength(), info.time );
+
+		if ( m_isLastSuppressed )
+		{
+			return;
+		}
 	}
+
+	WriteMessage( buffer, info, flags );
 }
 
-static void AddCurrentTime( LogBuffer & buffer )
+void EngineLog::Impl::WriteMessage( const LogBuffer & buffer, const LogMessageInfo & info, int flags )
 {
-	char timeBuffer[16];
-	time_t seconds = time( NULL );
-	tm *currentTime = localtime( &seconds );  // this must be called only from main thread
-	strftime( timeBuffer, sizeof timeBuffer, "%H:%M:%S", currentTime );
+	if ( flags & ELogFlags::FILE )
+	{
+		WriteToLogFile( buffer, info, flags );
+	}
 
-	buffer.append( timeBuffer );
+	if ( flags & ELogFlags::CONSOLE )
+	{
+		WriteToConsole( buffer, flags );
+	}
 }
 
-static void AddRelativeTime( LogBuffer & buffer, CTimeValue & lastTime, bool updateLastTime )
+static void AddRelativeTime( LogBuffer & buffer, long long time, long long & lastTime, bool updateLastTime )
 {
-	CTimeValue currentTime = gLauncher->pSystem->GetITimer()->GetAsyncTime();
-	CTimeValue relativeTime = currentTime - lastTime;
+	const long long relativeTime = time - lastTime;
 
 	if ( updateLastTime )
 	{
-		lastTime = currentTime;
+		lastTime = time;
 	}
 
-	buffer.append_f( "%7.3f", relativeTime.GetSeconds() );
+	buffer.append_fixed<3, 7>( Clock::TicksToSeconds( relativeTime ) );
 }
 
-void EngineLog::Impl::WriteToLogFile( const LogBuffer & buffer, int flags )
+void EngineLog::Impl::WriteToLogFile( const LogBuffer & buffer, const LogMessageInfo & info, int flags )
 {
 	if ( ! m_hLogFile )
 	{
@@ -187,39 +407,42 @@ void EngineLog::Impl::WriteToLogFile( const LogBuffer & buffer, int flags )
 
 	LogBuffer tempBuffer;
 
-	if ( includeTime > 0 && gLauncher->pSystem )
+	// time when the message was logged, not when it's being written
+	const long long time = info.time;
+
+	if ( includeTime > 0 )
 	{
 		switch ( includeTime )
 		{
 			case 1:
 			{
 				tempBuffer.append( '<' );
-				AddCurrentTime( tempBuffer );
+				tempBuffer.append( m_wallClock.GetLocalTimeOfDay( time ) );
 				tempBuffer.append( '>' );
 				break;
 			}
 			case 2:
 			{
 				tempBuffer.append( '<' );
-				AddRelativeTime( tempBuffer, m_includeTimeLastTime, true );
+				AddRelativeTime( tempBuffer, time, m_includeTimeLastTime, true );
 				tempBuffer.append( '>' );
 				break;
 			}
 			case 3:
 			{
 				tempBuffer.append( '<' );
-				AddCurrentTime( tempBuffer );
+				tempBuffer.append( m_wallClock.GetLocalTimeOfDay( time ) );
 				tempBuffer.append( '>' );
 				tempBuffer.append( ' ' );
 				tempBuffer.append( '[' );
-				AddRelativeTime( tempBuffer, m_includeTimeLastTime, true );
+				AddRelativeTime( tempBuffer, time, m_includeTimeLastTime, true );
 				tempBuffer.append( ']' );
 				break;
 			}
 			case 4:
 			{
 				tempBuffer.append( '<' );
-				AddRelativeTime( tempBuffer, m_includeTimeStartTime, false );
+				AddRelativeTime( tempBuffer, time, m_includeTimeStartTime, false );
 				tempBuffer.append( '>' );
 				break;
 			}
@@ -228,29 +451,26 @@ void EngineLog::Impl::WriteToLogFile( const LogBuffer & buffer, int flags )
 		tempBuffer.append( ": " );
 	}
 
-	for ( size_t i = 0; i < buffer.getLength(); i++ )
+	// skip control characters and color codes
+	char *text = tempBuffer.beginAppend( buffer.getLength() + 4 );  // the message, and up to 2 new lines
+	const size_t textLength = LogSanitizer::Sanitize( text, buffer.get(), buffer.getLength(), true );
+	tempBuffer.endAppend( textLength );
+
+	if ( m_logFileSize == 0 && strncmp( text, LOG_BACKUP_NAME_PREFIX, strlen( LOG_BACKUP_NAME_PREFIX ) ) == 0 )
 	{
-		if ( buffer[i] < 32 || buffer[i] == 127 )
-		{
-			// skip control characters
-		}
-		else if ( buffer[i] == '$' )
-		{
-			// convert "$$" to "$"
-			if ( buffer[i+1] == '$' )
-			{
-				tempBuffer.append( '$' );
-			}
+		// first line of the log file contains backup name attachment, which is needed again after rotation
+		m_backupNameLine.assign( text, textLength );
+	}
 
-			// skip color codes
-			i++;
-		}
-		else
-		{
-			tempBuffer.append( buffer[i] );
-		}
+	if ( m_hJsonFile )
+	{
+		// the JSON log uses the same stripped text
+		WriteToJsonFile( text, textLength, info, flags );
 	}
 
+	// the whole line without new line characters
+	m_logRing.Push( tempBuffer.get(), tempBuffer.getLength() );
+
 	// add new line character
 	tempBuffer.append( "\r\n" );  // CRLF
 
@@ -263,19 +483,103 @@ void EngineLog::Impl::WriteToLogFile( const LogBuffer & buffer, int flags )
 
 	const bool isNewLine = ! (flags & ELogFlags::APPEND);
 
-	if ( ! isNewLine )
+	// the writer moves file pointer before the last new line character if the message is appended
+	m_logWriter.Write( tempBuffer.get(), tempBuffer.getLength(), ! isNewLine, (flags & ELogFlags::FLUSH) != 0 );
+	m_logFileSize += tempBuffer.getLength();
+
+	for ( std::vector<ILogCallback*>::iterator it = m_callbacks.begin(); it != m_callbacks.end(); ++it )
 	{
-		// move file pointer before the last new line character
-		SetFilePointer( m_hLogFile, -2, NULL, FILE_END );  // CRLF is 2 bytes long
+		(*it)->OnWriteToFile( buffer.get(), isNewLine );
 	}
+}
 
-	DWORD bytesWritten;  // required
-	WriteFile( m_hLogFile, tempBuffer.get(), tempBuffer.getLength(), &bytesWritten, NULL );
+static const char *GetMsgTypeName( ILog::ELogType msgType )
+{
+	switch ( msgType )
+	{
+		case ILog::eMessage:       return "message";
+		case ILog::eWarning:       return "warning";
+		case ILog::eError:         return "error";
+		case ILog::eAlways:        return "always";
+		case ILog::eWarningAlways: return "warning_always";
+		case ILog::eErrorAlways:   return "error_always";
+		case ILog::eInput:         return "input";
+		case ILog::eInputResponse: return "input_response";
+		case ILog::eComment:       return "comment";
+	}
 
-	for ( std::vector<ILogCallback*>::iterator it = m_callbacks.begin(); it != m_callbacks.end(); ++it )
+	return "unknown";
+}
+
+static void AddJsonString( JsonLogBuffer & buffer, const char *text, size_t length )
+{
+	buffer.append( '\"' );
+
+	// the text is already sanitized, so it contains only printable ASCII characters
+	size_t begin = 0;
+	for ( size_t i = 0; i < length; i++ )
 	{
-		(*it)->OnWriteToFile( buffer.get(), isNewLine );
+		if ( text[i] == '\"' || text[i] == '\\' )
+		{
+			buffer.append( text + begin, i - begin );
+			buffer.append( '\\' );
+			begin = i;
+		}
+	}
+
+	buffer.append( text + begin, length - begin );
+	buffer.append( '\"' );
+}
+
+static void AddJsonWallTime( JsonLogBuffer & buffer, unsigned long long utcTime )
+{
+	FILETIME fileTime;
+	fileTime.dwLowDateTime = static_cast<DWORD>( utcTime );
+	fileTime.dwHighDateTime = static_cast<DWORD>( utcTime >> 32 );
+
+	SYSTEMTIME time;
+	FileTimeToSystemTime( &fileTime, &time );
+
+	buffer.append( '\"' );
+	buffer.append_uint<4, '0'>( time.wYear );
+	buffer.append( '-' );
+	buffer.append_uint<2, '0'>( time.wMonth );
+	buffer.append( '-' );
+	buffer.append_uint<2, '0'>( time.wDay );
+	buffer.append( 'T' );
+	buffer.append_uint<2, '0'>( time.wHour );
+	buffer.append( ':' );
+	buffer.append_uint<2, '0'>( time.wMinute );
+	buffer.append( ':' );
+	buffer.append_uint<2, '0'>( time.wSecond );
+	buffer.append( '.' );
+	buffer.append_uint<3, '0'>( time.wMilliseconds );
+	buffer.append( "Z\"" );
+}
+
+void EngineLog::Impl::WriteToJsonFile( const char *text, size_t length, const LogMessageInfo & info, int flags )
+{
+	JsonLogBuffer jsonBuffer;
+
+	jsonBuffer.append( "{\"type\":\"" );
+	jsonBuffer.append( GetMsgTypeName( info.type ) );
+	jsonBuffer.append( "\",\"thread\":" );
+	jsonBuffer.append_uint( info.threadID );
+	jsonBuffer.append( ",\"uptime\":" );
+	jsonBuffer.append_fixed<6, 0>( Clock::GetUptime( info.time ) );
+	jsonBuffer.append( ",\"time\":" );
+	AddJsonWallTime( jsonBuffer, m_wallClock.GetUTCTime( info.time ) );
+
+	if ( flags & ELogFlags::APPEND )
+	{
+		jsonBuffer.append( ",\"append\":true" );
 	}
+
+	jsonBuffer.append( ",\"text\":" );
+	AddJsonString( jsonBuffer, text, length );
+	jsonBuffer.append( "}\n" );
+
+	m_jsonWriter.Write( jsonBuffer.get(), jsonBuffer.getLength(), false, (flags & ELogFlags::FLUSH) != 0 );
 }
 
 void EngineLog::Impl::WriteToConsole( const LogBuffer & buffer, int flags )
@@ -305,17 +609,85 @@ void EngineLog::Impl::WriteToConsole( const LogBuffer & buffer, int flags )
 
 void EngineLog::Impl::OnIncludeTimeValueChanged( ICVar *pCVar )  // static function
 {
-	if ( ! gLauncher->pSystem )
+	Impl *self = gLauncher->pLog->GetEngineLog()->m_impl;
+
+	const long long currentTime = Clock::GetTicks();
+
+	self->m_includeTimeLastTime = currentTime;
+	self->m_includeTimeStartTime = currentTime;
+}
+
+void EngineLog::Impl::OnAsyncValueChanged( ICVar *pCVar )  // static function
+{
+	Impl *self = gLauncher->pLog->GetEngineLog()->m_impl;
+
+	if ( pCVar->GetIVal() > 0 )
 	{
-		return;
+		if ( ! self->StartWriterThreads() )
+		{
+			pCVar->Set( 0 );
+		}
 	}
+	else
+	{
+		self->StopWriterThreads();
+	}
+}
 
+void EngineLog::Impl::OnFlushIntervalValueChanged( ICVar *pCVar )  // static function
+{
 	Impl *self = gLauncher->pLog->GetEngineLog()->m_impl;
 
-	CTimeValue currentTime = gLauncher->pSystem->GetITimer()->GetAsyncTime();
+	const int flushInterval = pCVar->GetIVal();
 
-	self->m_includeTimeLastTime = currentTime;
-	self->m_includeTimeStartTime = currentTime;
+	self->m_logWriter.SetFlushInterval( (flushInterval > 0) ? flushInterval : 0 );
+	self->m_jsonWriter.SetFlushInterval( (flushInterval > 0) ? flushInterval : 0 );
+}
+
+void EngineLog::Impl::OnFloodValueChanged( ICVar *pCVar )  // static function
+{
+	Impl *self = gLauncher->pLog->GetEngineLog()->m_impl;
+
+	if ( self->m_pLogFloodCollapseCVar )
+	{
+		self->m_floodFilter.SetCollapseWindow( self->m_pLogFloodCollapseCVar->GetFVal() );
+	}
+
+	if ( self->m_pLogFloodLimitCVar && self->m_pLogFloodBurstCVar )
+	{
+		self->m_floodFilter.SetRateLimit( self->m_pLogFloodLimitCVar->GetFVal(), self->m_pLogFloodBurstCVar->GetIVal() );
+	}
+}
+
+void EngineLog::Impl::OnLogStatsCmd( IConsoleCmdArgs *pArgs )  // static function
+{
+	::Log *pLog = gLauncher->pLog;
+	const MemoryPool & taskPool = pLog->GetTaskPool();
+	Impl *self = pLog->GetEngineLog()->m_impl;
+
+	CryLogAlways( "$3Log statistics:" );
+	CryLogAlways( "Task pool | used = %ld/%lu | overflow = %ld",
+	  taskPool.GetUsedCount(), static_cast<unsigned long>( taskPool.GetBlockCount() ), taskPool.GetOverflowCount() );
+
+	CryLogAlways( "Flood filter | collapsed = %lu | limited = %lu",
+	  self->m_floodFilter.GetTotalCollapsedCount(), self->m_floodFilter.GetTotalLimitedCount() );
+
+	const LogWriter *pStdOutWriter = pLog->GetStdOutWriter();
+	const LogWriter *pStdErrWriter = pLog->GetStdErrWriter();
+
+	CryLogAlways( "Standard output | dropped lines = %ld | stderr dropped lines = %ld",
+	  (pStdOutWriter) ? pStdOutWriter->GetDroppedCount() : 0, (pStdErrWriter) ? pStdErrWriter->GetDroppedCount() : 0 );
+
+	if ( pLog->IsDeferredFormat() )
+	{
+		CryLogAlways( "Deferred formatting | deferred = %ld | formatted immediately = %ld",
+		  pLog->GetDeferredCount(), pLog->GetDeferredFallbackCount() );
+	}
+
+	if ( self->m_logRing.IsEnabled() )
+	{
+		CryLogAlways( "Log ring | lines = %lu", static_cast<unsigned long>( self->m_logRing.GetLineCount() ) );
+	}
 }
 
 void EngineLog::Impl::RegisterConsoleVariables()
@@ -355,6 +727,79 @@ void EngineLog::Impl::RegisterConsoleVariables()
 	  "  4 = Absolute time in seconds since this mode was started.",
 	  OnIncludeTimeValueChanged
 	);
+
+	m_pLogAsyncCVar = pConsole->RegisterInt( "log_Async", m_logWriter.IsThreadRunning() ? 1 : 0, VF_NOT_NET_SYNCED,
+	  "Toggles writing of the log file in a background thread.\n"
+	  "Usage: log_Async [0/1]\n"
+	  "  0 = Write the log file in the main thread.\n"
+	  "  1 = Write the log file in a background thread (same as -logasync command line parameter).\n"
+	  "The JSON log file enabled by -logjson command line parameter uses its own thread.",
+	  OnAsyncValueChanged
+	);
+
+	m_pLogFlushIntervalCVar = pConsole->RegisterInt( "log_FlushInterval", LOG_DEFAULT_FLUSH_INTERVAL, VF_NOT_NET_SYNCED,
+	  "Maximum time in milliseconds that log messages can stay in the log file write buffer.\n"
+	  "The buffer is also written when it's full, when an error is logged and when the log is closed.\n"
+	  "Buffering saves write calls, but if the server crashes, messages from up to this time before the crash\n"
+	  "can be lost, except for errors.\n"
+	  "Usage: log_FlushInterval [ms]\n"
+	  "  0 = Write each message immediately (default).",
+	  OnFlushIntervalValueChanged
+	);
+
+	m_pLogMaxSizeCVar = pConsole->RegisterInt( "log_MaxSize", 0, VF_NOT_NET_SYNCED,
+	  "Maximum size of the log file in megabytes. Larger log file is moved to LogBackups folder and a new one is created.\n"
+	  "Usage: log_MaxSize [MB]\n"
+	  "  0 = No limit (default)."
+	);
+
+	m_pLogRotateIntervalCVar = pConsole->RegisterInt( "log_RotateInterval", 0, VF_NOT_NET_SYNCED,
+	  "Time in minutes after which the log file is moved to LogBackups folder and a new one is created.\n"
+	  "Usage: log_RotateInterval [minutes]\n"
+	  "  0 = Never (default)."
+	);
+
+	m_pLogMaxBackupsCVar = pConsole->RegisterInt( "log_MaxBackups", 0, VF_NOT_NET_SYNCED,
+	  "Maximum number of log file backups kept in LogBackups folder when the log file is rotated.\n"
+	  "The oldest backups are deleted first.\n"
+	  "Usage: log_MaxBackups [count]\n"
+	  "  0 = Keep all backups (default)."
+	);
+
+	m_pLogCompressBackupsCVar = pConsole->RegisterInt( "log_CompressBackups", 0, VF_NOT_NET_SYNCED,
+	  "Toggles NTFS compression of rotated log files. The compression is done in background.\n"
+	  "Usage: log_CompressBackups [0/1]\n"
+	  "  0 = Off (default).\n"
+	  "  1 = On."
+	);
+
+	m_pLogFloodCollapseCVar = pConsole->RegisterFloat( "log_FloodCollapse", 0, VF_NOT_NET_SYNCED,
+	  "Time window in seconds for collapsing of repeated log messages.\n"
+	  "Repeats of a message logged within the window are counted and reported once when the window elapses.\n"
+	  "Messages of eAlways type and console input are never suppressed.\n"
+	  "Usage: log_FloodCollapse [seconds]\n"
+	  "  0 = Disabled (default).",
+	  OnFloodValueChanged
+	);
+
+	m_pLogFloodLimitCVar = pConsole->RegisterFloat( "log_FloodLimit", 0, VF_NOT_NET_SYNCED,
+	  "Maximum average number of log messages per second. The limit is applied to each message type separately.\n"
+	  "Messages of eAlways type and console input are never suppressed.\n"
+	  "Usage: log_FloodLimit [messages per second]\n"
+	  "  0 = No limit (default).",
+	  OnFloodValueChanged
+	);
+
+	m_pLogFloodBurstCVar = pConsole->RegisterInt( "log_FloodBurst", 100, VF_NOT_NET_SYNCED,
+	  "Maximum number of log messages of one type logged at once before log_FloodLimit is applied.\n"
+	  "Usage: log_FloodBurst [messages]",
+	  OnFloodValueChanged
+	);
+
+	pConsole->AddCommand( "log_stats", OnLogStatsCmd, 0,
+	  "Shows log statistics.\n"
+	  "Usage: log_stats"
+	);
 }
 
 void EngineLog::Impl::UnregisterConsoleVariables()
@@ -362,6 +807,15 @@ void EngineLog::Impl::UnregisterConsoleVariables()
 	m_pLogVerbosityCVar = NULL;
 	m_pLogFileVerbosityCVar = NULL;
 	m_pLogIncludeTimeCVar = NULL;
+	m_pLogAsyncCVar = NULL;
+	m_pLogFlushIntervalCVar = NULL;
+	m_pLogMaxSizeCVar = NULL;
+	m_pLogRotateIntervalCVar = NULL;
+	m_pLogMaxBackupsCVar = NULL;
+	m_pLogCompressBackupsCVar = NULL;
+	m_pLogFloodCollapseCVar = NULL;
+	m_pLogFloodLimitCVar = NULL;
+	m_pLogFloodBurstCVar = NULL;
 }
 
 void EngineLog::Impl::AddCallback( ILogCallback *pCallback )
@@ -427,15 +881,74 @@ static void LogInitError( const char *format, ... )
 	va_end( args );
 }
 
-static bool CreateLogBackup( HANDLE hFile, const char *path, const char *fileName )
+/**
+ * @brief Parses backup name attachment from the first line of a log file.
+ * @param line The first line.
+ * @param result The attachment is appended to this string.
+ * @return True if the attachment was found, otherwise false.
+ */
+static bool ParseBackupNameAttachment( const char *line, std::string & result )
+{
+	const char *prefix = LOG_BACKUP_NAME_PREFIX;
+	const size_t prefixLength = strlen( prefix );  // optimized out
+
+	if ( strncmp( line, prefix, prefixLength ) != 0 )
+	{
+		return false;
+	}
+
+	const char *nameAttachment = line + prefixLength;
+	if ( *nameAttachment != '\"' )
+	{
+		return false;
+	}
+
+	nameAttachment++;
+
+	size_t i = 0;  // length
+	while ( nameAttachment[i] != '\0' && nameAttachment[i] != '\"' )
+	{
+		i++;
+	}
+
+	result.append( nameAttachment, i );
+
+	return true;
+}
+
+static std::string GetLogBaseName( const char *fileName )
+{
+	std::string baseName = fileName;
+	// remove file extension
+	return baseName.substr( 0, baseName.find_last_of( '.' ) );
+}
+
+static std::string GetLogBackupFolderPath( const char *path )
+{
+	std::string backupFolderPath = path;
+	backupFolderPath += '\\';
+	backupFolderPath += "LogBackups";
+
+	return backupFolderPath;
+}
+
+enum ELogBackupResult
+{
+	eLBR_Failed,
+	eLBR_Empty,   //!< The existing log file is empty, so no backup was created.
+	eLBR_Moved,   //!< The existing log file was renamed. It's still open, so a new log file must be created.
+	eLBR_Copied   //!< The existing log file was copied. It must be truncated.
+};
+
+static ELogBackupResult CreateLogBackup( HANDLE hFile, const char *path, const char *fileName )
 {
 	// read first line from the existing log file
 	char lineBuffer[1024];
 	DWORD lineLength = 0;
-	if ( ! ReadFile( hFile, lineBuffer, sizeof lineBuffer, &lineLength, NULL ) )
+	if ( ! ReadFile( hFile, lineBuffer, sizeof lineBuffer - 1, &lineLength, NULL ) )  // keep space for terminator
 	{
 		LogInitError( "Unable to read from the existing log file: error code %lu", GetLastError() );
-		return false;
+		return eLBR_Failed;
 	}
 	else
 	{
@@ -450,112 +963,458 @@ static bool CreateLogBackup( HANDLE hFile, const char *path, const char *fileNam
 		lineBuffer[i] = '\0';
 	}
 
-	if ( lineLength == 0 )
+	if ( lineLength == 0 )
+	{
+		// the existing log file is empty, so no backup is needed
+		return eLBR_Empty;
+	}
+
+	std::string backupName = GetLogBaseName( fileName );
+
+	// parse backup name attachment stored in the existing log file
+	if ( ! ParseBackupNameAttachment( lineBuffer, backupName ) )
+	{
+		LogInitWarning( "No backup name attachment found in the existing log file!" );
+	}
+
+	std::string backupFolderPath = GetLogBackupFolderPath( path );
+
+	if ( ! CreateDirectoryA( backupFolderPath.c_str(), NULL ) && GetLastError() != ERROR_ALREADY_EXISTS )
+	{
+		LogInitError( "Unable to create LogBackups folder: error code %lu", GetLastError() );
+		return eLBR_Failed;
+	}
+
+	std::string logFilePath = path;
+	logFilePath += '\\';
+	logFilePath += fileName;
+
+	std::string backupFilePath = backupFolderPath;
+	backupFilePath += '\\';
+	backupFilePath += backupName;
+	backupFilePath += ".log";
+
+	// the log file is open with FILE_SHARE_DELETE, so it can be renamed without copying its content
+	if ( MoveFileExA( logFilePath.c_str(), backupFilePath.c_str(), MOVEFILE_REPLACE_EXISTING ) )
+	{
+		return eLBR_Moved;
+	}
+
+	if ( GetLastError() != ERROR_NOT_SAME_DEVICE )
+	{
+		LogInitError( "Unable to backup log file: error code %lu", GetLastError() );
+		return eLBR_Failed;
+	}
+
+	// LogBackups folder is on another volume
+	if ( ! CopyFile( logFilePath.c_str(), backupFilePath.c_str(), FALSE ) )
+	{
+		LogInitError( "Unable to backup log file: error code %lu", GetLastError() );
+		return eLBR_Failed;
+	}
+
+	return eLBR_Copied;
+}
+
+bool EngineLog::Impl::OpenLogFile( const char *fileName )
+{
+	if ( ! gLauncher->rootFolder )
+	{
+		return false;
+	}
+
+	m_logFileName = fileName;
+
+	std::string filePath = gLauncher->rootFolder;
+	filePath += '\\';
+	filePath += m_logFileName;
+
+	// the log file can be renamed while it's open, which is needed for rotation
+	m_hLogFile = CreateFileA( filePath.c_str(), GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ | FILE_SHARE_DELETE,
+	                          NULL, OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL );
+	if ( m_hLogFile == INVALID_HANDLE_VALUE )
+	{
+		m_hLogFile = NULL;
+		LogInitError( "Unable to create log file '%s': error code %lu", filePath.c_str(), GetLastError() );
+		return false;
+	}
+	else if ( GetLastError() == ERROR_ALREADY_EXISTS )
+	{
+		const long long backupStartTime = Clock::GetTicks();
+
+		const ELogBackupResult backupResult = CreateLogBackup( m_hLogFile, gLauncher->rootFolder, m_logFileName.c_str() );
+
+		switch ( backupResult )
+		{
+			case eLBR_Failed:
+			{
+				CloseHandle( m_hLogFile );
+				m_hLogFile = NULL;
+				return false;
+			}
+			case eLBR_Empty:
+			case eLBR_Copied:
+			{
+				// clear the existing file
+				SetFilePointer( m_hLogFile, 0, NULL, FILE_BEGIN );
+				SetEndOfFile( m_hLogFile );
+				break;
+			}
+			case eLBR_Moved:
+			{
+				// the handle now refers to the backup
+				CloseHandle( m_hLogFile );
+
+				m_hLogFile = CreateFileA( filePath.c_str(), GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ | FILE_SHARE_DELETE,
+				                          NULL, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL );
+				if ( m_hLogFile == INVALID_HANDLE_VALUE )
+				{
+					m_hLogFile = NULL;
+					LogInitError( "Unable to create log file '%s': error code %lu", filePath.c_str(), GetLastError() );
+					return false;
+				}
+				break;
+			}
+		}
+
+		if ( backupResult != eLBR_Empty )
+		{
+			const double backupTime = Clock::TicksToSeconds( Clock::GetTicks() - backupStartTime );
+
+			LogInitInfo( "Log file backup %s in %.3f ms", (backupResult == eLBR_Moved) ? "moved" : "copied", backupTime * 1000 );
+		}
+	}
+
+	m_logWriter.SetFile( m_hLogFile );
+	m_logWriter.SetFlushInterval( LOG_DEFAULT_FLUSH_INTERVAL );
+
+	m_logFileSize = 0;
+	m_rotateTime = Clock::GetTicks();
+
+	const int logRingSize = CmdLine::GetArgValueInt( "-logring" );
+	if ( logRingSize > 0 && ! m_logRing.IsEnabled() && ! m_logRing.Init( logRingSize ) )
+	{
+		LogInitWarning( "Unable to allocate log ring: error code %lu", GetLastError() );
+	}
+
+	std::string jsonFileName = CmdLine::GetArgValue( "-logjson" );
+	if ( ! jsonFileName.empty() )
+	{
+		// the JSON log is optional, so the launcher can continue without it
+		OpenJsonFile( jsonFileName.c_str() );
+	}
+
+	if ( CmdLine::HasArg( "-logasync" ) && ! StartWriterThreads() )
+	{
+		LogInitWarning( "Unable to start log writer thread: error code %lu", GetLastError() );
+	}
+
+	return true;
+}
+
+bool EngineLog::Impl::OpenJsonFile( const char *fileName )
+{
+	std::string filePath = gLauncher->rootFolder;
+	filePath += '\\';
+	filePath += fileName;
+
+	// existing JSON log is never truncated, so log shippers can simply follow the file
+	m_hJsonFile = CreateFileA( filePath.c_str(), GENERIC_WRITE, FILE_SHARE_READ,
+	                           NULL, OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL );
+	if ( m_hJsonFile == INVALID_HANDLE_VALUE )
+	{
+		m_hJsonFile = NULL;
+		LogInitWarning( "Unable to open JSON log file '%s': error code %lu", filePath.c_str(), GetLastError() );
+		return false;
+	}
+
+	SetFilePointer( m_hJsonFile, 0, NULL, FILE_END );
+
+	m_jsonWriter.SetFile( m_hJsonFile );
+	m_jsonWriter.SetFlushInterval( LOG_DEFAULT_FLUSH_INTERVAL );
+
+	return true;
+}
+
+struct LogBackupFile
+{
+	std::string name;
+	uint64 time;
+
+	LogBackupFile( const char *fileName, const FILETIME & fileTime )
+	: name(fileName),
+	  time((static_cast<uint64>( fileTime.dwHighDateTime ) << 32) | fileTime.dwLowDateTime)
+	{
+	}
+
+	bool operator<( const LogBackupFile & other ) const
+	{
+		return time < other.time;
+	}
+};
+
+/**
+ * @brief Checks if a file in the backup folder is a backup of the log file with the specified base name.
+ * Startup backups are followed by the name attachment or nothing and rotated backups by "_YYYYMMDD_HHMMSS".
+ * Backups of other log files whose names only begin with the same base name, e.g. "Server2", don't match.
+ */
+static bool IsLogBackupOf( const char *fileName, const std::string & baseName )
+{
+	// FindFirstFile is case-insensitive and also matches short names
+	if ( _strnicmp( fileName, baseName.c_str(), baseName.length() ) != 0 )
+	{
+		return false;
+	}
+
+	const char *suffix = fileName + baseName.length();
+
+	if ( _stricmp( suffix, ".log" ) == 0 )
+	{
+		// startup backup without name attachment
+		return true;
+	}
+
+	if ( suffix[0] == ' ' )
+	{
+		// startup or rotated backup with name attachment, which always begins with " Build("
+		return true;
+	}
+
+	if ( suffix[0] != '_' )
+	{
+		return false;
+	}
+
+	// rotated backup without name attachment
+	const char *format = "_dddddddd_dddddd.log";
+
+	for ( size_t i = 0; format[i]; i++ )
+	{
+		const bool isValid = (format[i] == 'd') ? (suffix[i] >= '0' && suffix[i] <= '9') : (suffix[i] == format[i]);
+
+		if ( ! isValid )
+		{
+			return false;
+		}
+	}
+
+	return suffix[strlen( format )] == '\0';
+}
+
+/**
+ * @brief Deletes the oldest backups of the log file.
+ * Backups are all files in the backup folder with the same base name, so startup backups are included.
+ */
+static void PruneLogBackups( const std::string & backupFolderPath, const std::string & baseName, int maxBackups )
+{
+	std::string pattern = backupFolderPath;
+	pattern += '\\';
+	pattern += baseName;
+	pattern += "*.log";
+
+	WIN32_FIND_DATAA findData;
+	HANDLE hFind = FindFirstFileA( pattern.c_str(), &findData );
+	if ( hFind == INVALID_HANDLE_VALUE )
+	{
+		return;
+	}
+
+	std::vector<LogBackupFile> backups;
+
+	do
+	{
+		if ( ! (findData.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY) && IsLogBackupOf( findData.cFileName, baseName ) )
+		{
+			backups.push_back( LogBackupFile( findData.cFileName, findData.ftLastWriteTime ) );
+		}
+	}
+	while ( FindNextFileA( hFind, &findData ) );
+
+	FindClose( hFind );
+
+	if ( backups.size() <= static_cast<size_t>( maxBackups ) )
+	{
+		return;
+	}
+
+	std::sort( backups.begin(), backups.end() );
+
+	const size_t deleteCount = backups.size() - maxBackups;
+
+	for ( size_t i = 0; i < deleteCount; i++ )
+	{
+		std::string filePath = backupFolderPath;
+		filePath += '\\';
+		filePath += backups[i].name;
+
+		if ( ! DeleteFileA( filePath.c_str() ) )
+		{
+			CryLogAlways( "$6[Warning] Unable to delete old log backup '%s': error code %lu", filePath.c_str(), GetLastError() );
+		}
+	}
+}
+
+static DWORD WINAPI CompressLogBackupRoutine( void *param )
+{
+	std::string *pFilePath = static_cast<std::string*>( param );
+
+	HANDLE hFile = CreateFileA( pFilePath->c_str(), GENERIC_READ | GENERIC_WRITE, 0,
+	                            NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL );
+	if ( hFile != INVALID_HANDLE_VALUE )
+	{
+		USHORT compressionFormat = COMPRESSION_FORMAT_DEFAULT;
+		DWORD bytesReturned;
+
+		// NTFS compresses the existing data synchronously
+		DeviceIoControl( hFile, FSCTL_SET_COMPRESSION, &compressionFormat, sizeof compressionFormat,
+		                 NULL, 0, &bytesReturned, NULL );
+
+		CloseHandle( hFile );
+	}
+
+	delete pFilePath;
+
+	return 0;
+}
+
+void EngineLog::Impl::UpdateRotation()
+{
+	if ( ! m_hLogFile || ! m_pLogMaxSizeCVar || ! m_pLogRotateIntervalCVar )
 	{
-		// the existing log file is empty, so no backup is needed
-		return true;
+		return;
 	}
 
-	std::string backupName = fileName;
-	// remove file extension
-	backupName = backupName.substr( 0, backupName.find_last_of( '.' ) );
-
-	const char *prefix = "BackupNameAttachment=";
-	const size_t prefixLength = strlen( prefix );  // optimized out
+	const int maxSize = m_pLogMaxSizeCVar->GetIVal();
+	const int rotateInterval = m_pLogRotateIntervalCVar->GetIVal();
 
-	bool hasNameAttachment = false;
+	bool isRotationTime = false;
 
-	// parse backup name attachment stored in the existing log file
-	if ( strncmp( lineBuffer, prefix, prefixLength ) == 0 )
+	if ( maxSize > 0 && m_logFileSize >= static_cast<uint64>( maxSize ) * 1024 * 1024 )
 	{
-		const char *nameAttachment = lineBuffer + prefixLength;
-		if ( *nameAttachment == '\"' )
-		{
-			nameAttachment++;
-
-			size_t i = 0;  // length
-			while ( nameAttachment[i] != '\0' && nameAttachment[i] != '\"' )
-			{
-				i++;
-			}
+		isRotationTime = true;
+	}
 
-			backupName.append( nameAttachment, i );
-			hasNameAttachment = true;
-		}
+	if ( rotateInterval > 0 && (Clock::GetTicks() - m_rotateTime) >= Clock::SecondsToTicks( rotateInterval * 60.0 ) )
+	{
+		isRotationTime = true;
 	}
 
-	if ( ! hasNameAttachment )
+	if ( isRotationTime )
 	{
-		LogInitWarning( "No backup name attachment found in the existing log file!" );
+		RotateLogFile();
 	}
+}
 
-	std::string backupFolderPath = path;
-	backupFolderPath += '\\';
-	backupFolderPath += "LogBackups";
+/**
+ * @brief Moves the current log file to the backup folder and continues with a new one.
+ * The file is renamed while it's still open, so no data are copied.
+ */
+void EngineLog::Impl::RotateLogFile()
+{
+	// start counting again even if the rotation fails, so it isn't retried in each frame
+	m_logFileSize = 0;
+	m_rotateTime = Clock::GetTicks();
+
+	const std::string baseName = GetLogBaseName( m_logFileName.c_str() );
+	const std::string backupFolderPath = GetLogBackupFolderPath( gLauncher->rootFolder );
 
 	if ( ! CreateDirectoryA( backupFolderPath.c_str(), NULL ) && GetLastError() != ERROR_ALREADY_EXISTS )
 	{
-		LogInitError( "Unable to create LogBackups folder: error code %lu", GetLastError() );
-		return false;
+		CryLogAlways( "$4[Error] Unable to create LogBackups folder: error code %lu", GetLastError() );
+		return;
 	}
 
-	std::string logFilePath = path;
+	std::string backupName = baseName;
+	ParseBackupNameAttachment( m_backupNameLine.c_str(), backupName );
+
+	// multiple backups have the same name attachment, so the current time is added
+	char timeBuffer[32];
+	time_t seconds = time( NULL );
+	strftime( timeBuffer, sizeof timeBuffer, "_%Y%m%d_%H%M%S", localtime( &seconds ) );
+	backupName += timeBuffer;
+
+	std::string logFilePath = gLauncher->rootFolder;
 	logFilePath += '\\';
-	logFilePath += fileName;
+	logFilePath += m_logFileName;
 
 	std::string backupFilePath = backupFolderPath;
 	backupFilePath += '\\';
 	backupFilePath += backupName;
 	backupFilePath += ".log";
 
-	LogInitInfo( "Creating log file backup..." );
+	// write everything to the current file before it's moved
+	m_logWriter.Flush();
 
-	if ( ! CopyFile( logFilePath.c_str(), backupFilePath.c_str(), FALSE ) )
+	if ( ! MoveFileExA( logFilePath.c_str(), backupFilePath.c_str(), 0 ) )
 	{
-		LogInitError( "Unable to backup log file: error code %lu", GetLastError() );
-		return false;
+		CryLogAlways( "$4[Error] Unable to rotate log file: error code %lu", GetLastError() );
+		return;
 	}
 
-	return true;
-}
-
-bool EngineLog::Impl::OpenLogFile( const char *fileName )
-{
-	if ( ! gLauncher->rootFolder )
+	HANDLE hNewFile = CreateFileA( logFilePath.c_str(), GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ | FILE_SHARE_DELETE,
+	                               NULL, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL );
+	if ( hNewFile == INVALID_HANDLE_VALUE )
 	{
-		return false;
+		// continue with the moved file
+		CryLogAlways( "$4[Error] Unable to create new log file after rotation: error code %lu", GetLastError() );
+		return;
 	}
 
-	m_logFileName = fileName;
+	m_logWriter.SetFile( hNewFile );
+	CloseHandle( m_hLogFile );
+	m_hLogFile = hNewFile;
 
-	std::string filePath = gLauncher->rootFolder;
-	filePath += '\\';
-	filePath += m_logFileName;
+	if ( ! m_backupNameLine.empty() )
+	{
+		// keep the backup name attachment in the first line
+		std::string line = m_backupNameLine;
+		line += "\r\n";  // CRLF
 
-	m_hLogFile = CreateFileA( filePath.c_str(), GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ,
-	                          NULL, OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL );
-	if ( m_hLogFile == INVALID_HANDLE_VALUE )
+		m_logWriter.Write( line.c_str(), line.length() );
+		m_logFileSize += line.length();
+	}
+
+	CryLogAlways( "Log file rotated to '%s'", backupFilePath.c_str() );
+
+	const int maxBackups = (m_pLogMaxBackupsCVar) ? m_pLogMaxBackupsCVar->GetIVal() : 0;
+	if ( maxBackups > 0 )
 	{
-		m_hLogFile = NULL;
-		LogInitError( "Unable to create log file '%s': error code %lu", filePath.c_str(), GetLastError() );
-		return false;
+		PruneLogBackups( backupFolderPath, baseName, maxBackups );
 	}
-	else if ( GetLastError() == ERROR_ALREADY_EXISTS )
+
+	if ( m_pLogCompressBackupsCVar && m_pLogCompressBackupsCVar->GetIVal() > 0 )
 	{
-		if ( ! CreateLogBackup( m_hLogFile, gLauncher->rootFolder, m_logFileName.c_str() ) )
+		std::string *pFilePath = new std::string( backupFilePath );
+
+		if ( ! QueueUserWorkItem( CompressLogBackupRoutine, pFilePath, WT_EXECUTELONGFUNCTION ) )
 		{
-			CloseHandle( m_hLogFile );
-			return false;
+			delete pFilePath;
 		}
+	}
+}
+
+bool EngineLog::Impl::StartWriterThreads()
+{
+	if ( ! m_logWriter.StartThread( LOG_ASYNC_QUEUE_SIZE ) )
+	{
+		return false;
+	}
 
-		// clear the existing file
-		SetFilePointer( m_hLogFile, 0, NULL, FILE_BEGIN );
-		SetEndOfFile( m_hLogFile );
+	if ( m_hJsonFile && ! m_jsonWriter.StartThread( LOG_ASYNC_QUEUE_SIZE ) )
+	{
+		m_logWriter.StopThread();
+		return false;
 	}
 
 	return true;
 }
 
+void EngineLog::Impl::StopWriterThreads()
+{
+	m_logWriter.StopThread();
+	m_jsonWriter.StopThread();
+}
+
 static bool CheckVerbosity( ILog::ELogType msgType, int verbosity )
 {
 	switch ( msgType )
@@ -589,26 +1448,23 @@ static bool CheckVerbosity( ILog::ELogType msgType, int verbosity )
 	return false;
 }
 
-static void AddMsgPrefix( LogBuffer & buffer, ILog::ELogType msgType )
+static const char *GetMsgPrefix( ILog::ELogType msgType )
 {
 	switch ( msgType )
 	{
 		case ILog::eWarning:
 		case ILog::eWarningAlways:
 		{
-			buffer.append( "$6[Warning] " );
-			break;
+			return "$6[Warning] ";
 		}
 		case ILog::eError:
 		case ILog::eErrorAlways:
 		{
-			buffer.append( "$4[Error] " );
-			break;
+			return "$4[Error] ";
 		}
 		case ILog::eComment:
 		{
-			buffer.append( "$9" );  // new feature
-			break;
+			return "$9";  // new feature
 		}
 		case ILog::eMessage:
 		case ILog::eAlways:
@@ -618,16 +1474,17 @@ static void AddMsgPrefix( LogBuffer & buffer, ILog::ELogType msgType )
 			break;
 		}
 	}
+
+	return "";
 }
 
-void EngineLog::Impl::Log( ILog::ELogType msgType, const char *format, va_list args, int flags )
+static void AddMsgPrefix( LogBuffer & buffer, ILog::ELogType msgType )
 {
-	// yes, Crysis really contains code that calls log with NULL format parameter...
-	if ( ! format )
-	{
-		return;
-	}
+	buffer.append( GetMsgPrefix( msgType ) );
+}
 
+int EngineLog::Impl::ApplyVerbosity( ILog::ELogType msgType, int flags ) const
+{
 	int verbosity = GetVerbosity();
 
 	if ( flags & ELogFlags::CONSOLE )
@@ -655,28 +1512,131 @@ void EngineLog::Impl::Log( ILog::ELogType msgType, const char *format, va_list a
 		}
 	}
 
+	return flags;
+}
+
+void EngineLog::Impl::OnFloodReport( const LogFloodFilter::Report & report, void *param )  // static function
+{
+	Impl *self = static_cast<Impl*>( param );
+
+	LogMessageInfo info;
+	info.type = (report.isRepeat) ? static_cast<ILog::ELogType>( report.type ) : ILog::eWarningAlways;
+	info.threadID = GetCurrentThreadId();
+	info.time = Clock::GetTicks();
+
+	const int flags = self->ApplyVerbosity( info.type, ELogFlags::FILE | ELogFlags::CONSOLE );
+
+	if ( ! flags )
+	{
+		return;
+	}
+
+	LogBuffer buffer;
+	AddMsgPrefix( buffer, info.type );
+
+	if ( report.isRepeat )
+	{
+		const char *prefix = GetMsgPrefix( info.type );
+		const size_t prefixLength = strlen( prefix );
+
+		// the message is stored with its prefix
+		const char *text = report.text;
+		if ( strncmp( text, prefix, prefixLength ) == 0 )
+		{
+			text += prefixLength;
+		}
+
+		buffer.append( "Last message repeated " );
+		buffer.append_uint( report.count );
+		buffer.append( " times: " );
+		buffer.append( text );
+	}
+	else
+	{
+		buffer.append( "Log flood limit suppressed " );
+		buffer.append_uint( report.count );
+		buffer.append( ' ' );
+		buffer.append( GetMsgTypeName( static_cast<ILog::ELogType>( report.type ) ) );
+		buffer.append( " messages" );
+	}
+
+	// the report itself is not filtered
+	self->WriteMessage( buffer, info, flags );
+}
+
+void EngineLog::Impl::Log( ILog::ELogType msgType, const char *format, va_list args, int flags )
+{
+	// yes, Crysis really contains code that calls log with NULL format parameter...
+	if ( ! format )
+	{
+		return;
+	}
+
+	flags = ApplyVerbosity( msgType, flags );
+
+	if ( msgType == ILog::eError || msgType == ILog::eErrorAlways )
+	{
+		// don't let errors stay in the write buffer
+		flags |= ELogFlags::FLUSH;
+	}
+
 	if ( flags & ELogFlags::FILE || flags & ELogFlags::CONSOLE )
 	{
+		LogMessageInfo info;
+		info.type = msgType;
+		info.threadID = GetCurrentThreadId();
+		info.time = Clock::GetTicks();
+
 		if ( IsMainThread() )
 		{
 			LogBuffer buffer;
 			AddMsgPrefix( buffer, msgType );
 			buffer.append_vf( format, args );
 
-			DoLog( buffer, flags );
+			DoLog( buffer, info, flags );
 		}
 		else
 		{
+			// errors are never deferred by the frame task budget, so they get to the file even if the process dies
+			const ELauncherTaskPriority priority = (flags & ELogFlags::FLUSH) ? eLTP_High : eLTP_Low;
+
+			if ( gLauncher->pLog->IsDeferredFormat() )
+			{
+				DeferredLogTask *pTask = new DeferredLogTask( this );
+
+				if ( CaptureLogArgs( pTask->record, format, args ) )
+				{
+					pTask->info = info;
+					pTask->flags = flags;
+
+					gLauncher->pTaskSystem->AddTask( pTask, priority );
+					return;
+				}
+
+				// the arguments don't fit into the record, so the message is formatted now
+				delete pTask;
+			}
+
 			LogTask *pTask = new LogTask( this );
 			AddMsgPrefix( pTask->buffer, msgType );
 			pTask->buffer.append_vf( format, args );
+			pTask->info = info;
 			pTask->flags = flags;
 
-			gLauncher->pTaskSystem->AddTask( pTask );
+			gLauncher->pTaskSystem->AddTask( pTask, priority );
 		}
 	}
 }
 
+void EngineLog::Impl::DeferredLogTask::Run()
+{
+	LogBuffer buffer;
+	AddMsgPrefix( buffer, info.type );
+	AppendLogArgs( buffer, record );
+
+	pContext->DoLog( buffer, info, flags );
+}
+
 EngineLog::EngineLog()
 : m_impl(new Impl())
 {
@@ -818,6 +1778,43 @@ void EngineLog::UpdateLoadingScreen( const char *format, ... )
 	//}
 }
 
+/**
+ * @brief Writes buffered log messages if the flush interval has elapsed.
+ * It does nothing if called from other thread than main.
+ */
+void EngineLog::Update()
+{
+	m_impl->Update();
+}
+
+/**
+ * @brief Writes all buffered log messages.
+ * It does nothing if called from other thread than main.
+ */
+void EngineLog::Flush()
+{
+	m_impl->Flush();
+}
+
+/**
+ * @brief Copies recent log lines from the in-memory log ring enabled by -logring command line parameter.
+ * This function can be called from any thread. See LogRing::Copy for description of the parameters.
+ */
+size_t EngineLog::CopyRecentLines( unsigned long long seq, char *buffer, size_t bufferSize, unsigned long long *pFirstSeq,
+                                   unsigned long long *pNextSeq )
+{
+	return m_impl->CopyRecentLines( seq, buffer, bufferSize, pFirstSeq, pNextSeq );
+}
+
+/**
+ * @brief Copies the most recent log lines from the in-memory log ring enabled by -logring command line parameter.
+ * This function can be called from any thread. See LogRing::CopyLast for description of the parameters.
+ */
+size_t EngineLog::CopyLastLines( size_t lineCount, char *buffer, size_t bufferSize )
+{
+	return m_impl->CopyLastLines( lineCount, buffer, bufferSize );
+}
+
 void EngineLog::RegisterConsoleVariables()
 {
 	m_impl->RegisterConsoleVariables();
@@ -857,26 +1854,17 @@ static void WriteToFile( HANDLE hFile, const LogBuffer & buffer )
 
 	LogBuffer tempBuffer;
 
-	for ( size_t i = 0; i < buffer.getLength(); i++ )
-	{
-		if ( buffer[i] < 32 || buffer[i] == 127 )
-		{
-			// skip control characters
-		}
-		else
-		{
-			tempBuffer.append( buffer[i] );
-		}
-	}
+	// skip control characters
+	char *text = tempBuffer.beginAppend( buffer.getLength() + 2 );  // the message and new line
+	tempBuffer.endAppend( LogSanitizer::Sanitize( text, buffer.get(), buffer.getLength(), false ) );
 
 	// add new line character
 	tempBuffer.append( "\r\n" );  // CRLF
 
-	DWORD bytesWritten;
-	WriteFile( hFile, tempBuffer.get(), tempBuffer.getLength(), &bytesWritten, NULL );
+	gLauncher->pLog->WriteToStdFile( hFile, tempBuffer.get(), tempBuffer.getLength() );
 }
 
-struct WriteToFileTask : public ILauncherTask
+struct WriteToFileTask : public PooledLogTask
 {
 	LogBuffer buffer;
 	HANDLE hFile;
@@ -893,8 +1881,112 @@ struct WriteToFileTask : public ILauncherTask
 	}
 };
 
+struct DeferredWriteToFileTask : public PooledLogTask
+{
+	char prefix[LOG_DEFERRED_PREFIX_SIZE];
+	unsigned char record[LOG_DEFERRED_RECORD_SIZE];
+	HANDLE hFile;
+
+	DeferredWriteToFileTask()
+	: hFile()
+	{
+		prefix[0] = '\0';
+	}
+
+	void Run() override
+	{
+		LogBuffer buffer;
+		buffer.append( prefix );
+		AppendLogArgs( buffer, record );
+
+		WriteToFile( hFile, buffer );
+	}
+};
+
+/**
+ * @brief Passes message for standard output or standard error to main thread.
+ */
+static void DispatchWriteToFile( HANDLE hFile, const char *format, va_list args, const char *prefix )
+{
+	if ( gLauncher->pLog->IsDeferredFormat() && (! prefix || strlen( prefix ) < LOG_DEFERRED_PREFIX_SIZE) )
+	{
+		DeferredWriteToFileTask *pTask = new DeferredWriteToFileTask();
+
+		if ( CaptureLogArgs( pTask->record, format, args ) )
+		{
+			if ( prefix )
+			{
+				strcpy( pTask->prefix, prefix );
+			}
+
+			pTask->hFile = hFile;
+
+			gLauncher->pTaskSystem->AddTask( pTask, eLTP_Low );
+			return;
+		}
+
+		// the arguments don't fit into the record, so the message is formatted now
+		delete pTask;
+	}
+
+	WriteToFileTask *pTask = new WriteToFileTask();
+	pTask->buffer.append( prefix );
+	pTask->buffer.append_vf( format, args );
+	pTask->hFile = hFile;
+
+	gLauncher->pTaskSystem->AddTask( pTask, eLTP_Low );
+}
+
+/**
+ * @brief Creates writer thread for standard output or standard error.
+ * The thread never blocks the main thread. If the consumer is too slow, the oldest lines are dropped.
+ */
+static LogWriter *CreateStdWriter( DWORD stdHandleID )
+{
+	HANDLE hFile = GetStdHandle( stdHandleID );
+	if ( ! hFile || hFile == INVALID_HANDLE_VALUE )
+	{
+		return NULL;
+	}
+
+	LogWriter *pWriter = new LogWriter();
+	pWriter->SetFile( hFile );
+	pWriter->SetDropOldest( true );
+
+	if ( ! pWriter->StartThread( LOG_STD_QUEUE_SIZE ) )
+	{
+		LogInitWarning( "Unable to start writer thread for standard output: error code %lu", GetLastError() );
+		delete pWriter;
+		return NULL;
+	}
+
+	return pWriter;
+}
+
+static void DestroyStdWriter( LogWriter *pWriter )
+{
+	if ( ! pWriter )
+	{
+		return;
+	}
+
+	// write everything that is still queued, but don't wait forever for a stuck consumer
+	if ( pWriter->StopThread( LOG_STD_STOP_TIMEOUT ) )
+	{
+		delete pWriter;
+	}
+
+	// otherwise the writer is intentionally leaked because its thread is still using it
+}
+
 Log::Log()
-: m_pEngineLog()
+: m_pEngineLog(),
+  m_taskPool(),
+  m_pStdOutWriter(),
+  m_pStdErrWriter(),
+  m_isDeferredFormat(false),
+  m_deferredCount(0),
+  m_deferredFallbackCount(0)
 {
 }
 
@@ -904,6 +1996,9 @@ Log::~Log()
 	{
 		delete m_pEngineLog;
 	}
+
+	DestroyStdWriter( m_pStdOutWriter );
+	DestroyStdWriter( m_pStdErrWriter );
 }
 
 void Log::LogToStdOut( const char *format, ... )
@@ -934,12 +2029,7 @@ void Log::LogToStdOutV( const char *format, va_list args, const char *prefix )
 	}
 	else
 	{
-		WriteToFileTask *pTask = new WriteToFileTask();
-		pTask->buffer.append( prefix );
-		pTask->buffer.append_vf( format, args );
-		pTask->hFile = GetStdHandle( STD_OUTPUT_HANDLE );
-
-		gLauncher->pTaskSystem->AddTask( pTask );
+		DispatchWriteToFile( GetStdHandle( STD_OUTPUT_HANDLE ), format, args, prefix );
 	}
 }
 
@@ -955,25 +2045,78 @@ void Log::LogToStdErrV( const char *format, va_list args, const char *prefix )
 	}
 	else
 	{
-		WriteToFileTask *pTask = new WriteToFileTask();
-		pTask->buffer.append( prefix );
-		pTask->buffer.append_vf( format, args );
-		pTask->hFile = GetStdHandle( STD_ERROR_HANDLE );
+		DispatchWriteToFile( GetStdHandle( STD_ERROR_HANDLE ), format, args, prefix );
+	}
+}
+
+/**
+ * @brief Writes data to standard output or standard error.
+ * The data are passed to the writer thread if it's running. This function must be called only from main thread.
+ * @param hFile Standard output or standard error handle.
+ */
+void Log::WriteToStdFile( void *hFile, const char *data, size_t length )
+{
+	if ( m_pStdOutWriter && m_pStdOutWriter->GetFile() == hFile )
+	{
+		m_pStdOutWriter->Write( data, length );
+	}
+	else if ( m_pStdErrWriter && m_pStdErrWriter->GetFile() == hFile )
+	{
+		m_pStdErrWriter->Write( data, length );
+	}
+	else
+	{
+		DWORD bytesWritten;
+		WriteFile( hFile, data, static_cast<DWORD>( length ), &bytesWritten, NULL );
+	}
+}
 
-		gLauncher->pTaskSystem->AddTask( pTask );
+/**
+ * @brief Writes data to standard error without any help of main thread.
+ * Unlike LogToStdErr, this function works even while main thread is stuck. It can be called from any thread.
+ * The data are passed to the writer thread if it's running, otherwise they're written directly.
+ */
+void Log::WriteToStdErrNow( const char *data, size_t length )
+{
+	if ( m_pStdErrWriter && m_pStdErrWriter->IsThreadRunning() )
+	{
+		// the queue is protected by a lock
+		m_pStdErrWriter->Write( data, length );
 	}
+	else
+	{
+		DWORD bytesWritten;
+		WriteFile( GetStdHandle( STD_ERROR_HANDLE ), data, static_cast<DWORD>( length ), &bytesWritten, NULL );
+	}
+}
+
+void Log::OnDeferred( bool isCaptured )
+{
+	InterlockedIncrement( (isCaptured) ? &m_deferredCount : &m_deferredFallbackCount );
 }
 
 bool Log::InitEngineLog()
 {
 	std::string logFileName = CmdLine::GetArgValue( "-logfile", LOG_DEFAULT_FILE_NAME );
 	gLauncher->defaultLogVerbosity = CmdLine::GetArgValueInt( "-verbosity", LOG_DEFAULT_VERBOSITY );
+	m_isDeferredFormat = CmdLine::HasArg( "-logdeferred" );
 
 	if ( ! m_pEngineLog )
 	{
 		m_pEngineLog = new EngineLog();
 	}
 
+	if ( ! m_taskPool.GetBlockCount() && ! m_taskPool.Init( LOG_TASK_POOL_BLOCK_SIZE, LOG_TASK_POOL_SIZE ) )
+	{
+		LogInitWarning( "Unable to allocate log task pool: error code %lu", GetLastError() );
+	}
+
+	if ( ! m_pStdOutWriter && ! m_pStdErrWriter )
+	{
+		m_pStdOutWriter = CreateStdWriter( STD_OUTPUT_HANDLE );
+		m_pStdErrWriter = CreateStdWriter( STD_ERROR_HANDLE );
+	}
+
 	return m_pEngineLog->SetFileName( logFileName.c_str() );
 }
 
@@ -11,6 +11,11 @@
 // CryEngine headers
 #include "ILog.h"
 
+// Launcher headers
+#include "MemoryPool.h"
+
+class LogWriter;
+
 class EngineLog : public ILog
 {
 	class Impl;
@@ -51,11 +56,26 @@ public:
 
 	void AddCallback( ILogCallback *pCallback ) override;
 	void RemoveCallback( ILogCallback *pCallback ) override;
+
+	// --- Launcher ---
+
+	void Update();
+	void Flush();
+
+	size_t CopyRecentLines( unsigned long long seq, char *buffer, size_t bufferSize, unsigned long long *pFirstSeq,
+	                        unsigned long long *pNextSeq );
+	size_t CopyLastLines( size_t lineCount, char *buffer, size_t bufferSize );
 };
 
 class Log
 {
 	EngineLog *m_pEngineLog;
+	MemoryPool m_taskPool;
+	LogWriter *m_pStdOutWriter;
+	LogWriter *m_pStdErrWriter;
+	bool m_isDeferredFormat;
+	volatile long m_deferredCount;
+	volatile long m_deferredFallbackCount;
 
 public:
 	Log();
@@ -69,9 +89,44 @@ public:
 
 	bool InitEngineLog();
 
+	void WriteToStdFile( void *hFile, const char *data, size_t length );
+	void WriteToStdErrNow( const char *data, size_t length );
+
+	const LogWriter *GetStdOutWriter() const
+	{
+		return m_pStdOutWriter;
+	}
+
+	const LogWriter *GetStdErrWriter() const
+	{
+		return m_pStdErrWriter;
+	}
+
 	EngineLog *GetEngineLog()
 	{
 		return m_pEngineLog;
 	}
+
+	MemoryPool & GetTaskPool()
+	{
+		return m_taskPool;
+	}
+
+	bool IsDeferredFormat() const
+	{
+		return m_isDeferredFormat;
+	}
+
+	void OnDeferred( bool isCaptured );
+
+	long GetDeferredCount() const
+	{
+		return m_deferredCount;
+	}
+
+	long GetDeferredFallbackCount() const
+	{
+		return m_deferredFallbackCount;
+	}
 };
 
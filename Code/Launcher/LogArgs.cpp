@@ -0,0 +1,483 @@
+/**
+ * @file
+ * @brief Implementation of capturing of log message arguments for deferred formatting.
+ *
+ * The captured record contains copy of the format string followed by binary copy of all arguments. Strings are copied
+ * too, so the record doesn't depend on any memory of the caller. The format string is parsed exactly like vsnprintf_
+ * does it, so each argument is read with the same type.
+ */
+
+#include <string.h>
+#include <stddef.h>
+
+// Library headers
+#include "printf/printf.h"
+
+// Launcher headers
+#include "LogArgs.h"
+
+// longer format specifiers are not supported
+#define LOG_ARGS_MAX_SPEC_LENGTH 32
+
+enum EArgType
+{
+	eAT_None,
+	eAT_Int,
+	eAT_Long,
+	eAT_LongLong,
+	eAT_Double,
+	eAT_Pointer,
+	eAT_String
+};
+
+struct FormatSpec
+{
+	const char *begin;  //!< The '%' character.
+	size_t length;
+	int starCount;      //!< Number of width and precision arguments.
+	bool hasPrecision;
+	bool isPrecisionStar;
+	bool isComplete;    //!< False if the format string ends inside the specifier.
+	unsigned int precision;
+	EArgType type;
+};
+
+static bool IsDigit( char c )
+{
+	return c >= '0' && c <= '9';
+}
+
+/**
+ * @brief Parses one format specifier.
+ * @param format Pointer to the '%' character.
+ * @return Pointer to the first character after the specifier.
+ */
+static const char *ParseSpec( const char *format, FormatSpec & spec )
+{
+	spec.begin = format;
+	spec.starCount = 0;
+	spec.hasPrecision = false;
+	spec.isPrecisionStar = false;
+	spec.precision = 0;
+	spec.type = eAT_None;
+
+	format++;
+
+	// flags
+	while ( *format == '0' || *format == '-' || *format == '+' || *format == ' ' || *format == '#' )
+	{
+		format++;
+	}
+
+	// width
+	if ( IsDigit( *format ) )
+	{
+		while ( IsDigit( *format ) )
+		{
+			format++;
+		}
+	}
+	else if ( *format == '*' )
+	{
+		spec.starCount++;
+		format++;
+	}
+
+	// precision
+	if ( *format == '.' )
+	{
+		spec.hasPrecision = true;
+		format++;
+
+		if ( IsDigit( *format ) )
+		{
+			while ( IsDigit( *format ) )
+			{
+				spec.precision = (spec.precision * 10) + (*format - '0');
+				format++;
+			}
+		}
+		else if ( *format == '*' )
+		{
+			spec.starCount++;
+			spec.isPrecisionStar = true;
+			format++;
+		}
+	}
+
+	// length
+	EArgType integerType = eAT_Int;
+
+	switch ( *format )
+	{
+		case 'l':
+		{
+			integerType = eAT_Long;
+			format++;
+
+			if ( *format == 'l' )
+			{
+				integerType = eAT_LongLong;
+				format++;
+			}
+			break;
+		}
+		case 'h':
+		{
+			format++;
+
+			if ( *format == 'h' )
+			{
+				format++;
+			}
+			break;
+		}
+		case 't':
+		{
+			integerType = (sizeof (ptrdiff_t) == sizeof (long)) ? eAT_Long : eAT_LongLong;
+			format++;
+			break;
+		}
+		case 'j':
+		case 'z':
+		{
+			integerType = (sizeof (size_t) == sizeof (long)) ? eAT_Long : eAT_LongLong;
+			format++;
+			break;
+		}
+	}
+
+	// specifier
+	switch ( *format )
+	{
+		case 'd':
+		case 'i':
+		case 'u':
+		case 'x':
+		case 'X':
+		case 'o':
+		case 'b':
+		{
+			spec.type = integerType;
+			break;
+		}
+		case 'f':
+		case 'F':
+		case 'e':
+		case 'E':
+		case 'g':
+		case 'G':
+		{
+			spec.type = eAT_Double;
+			break;
+		}
+		case 'c':
+		{
+			spec.type = eAT_Int;
+			break;
+		}
+		case 's':
+		{
+			spec.type = eAT_String;
+			break;
+		}
+		case 'p':
+		{
+			spec.type = eAT_Pointer;
+			break;
+		}
+	}
+
+	spec.isComplete = (*format != '\0');
+
+	if ( spec.isComplete )
+	{
+		format++;
+	}
+
+	spec.length = format - spec.begin;
+
+	return format;
+}
+
+class RecordWriter
+{
+	unsigned char *m_pos;
+	unsigned char *m_end;
+
+public:
+	RecordWriter( void *record, size_t recordSize )
+	: m_pos(static_cast<unsigned char*>( record )),
+	  m_end(static_cast<unsigned char*>( record ) + recordSize)
+	{
+	}
+
+	bool Write( const void *data, size_t length )
+	{
+		if ( length > static_cast<size_t>( m_end - m_pos ) )
+		{
+			return false;
+		}
+
+		memcpy( m_pos, data, length );
+		m_pos += length;
+
+		return true;
+	}
+
+	template<class T>
+	bool Write( const T & value )
+	{
+		return Write( &value, sizeof value );
+	}
+
+	unsigned char *GetPos() const
+	{
+		return m_pos;
+	}
+};
+
+class RecordReader
+{
+	const unsigned char *m_pos;
+
+public:
+	RecordReader( const void *record )
+	: m_pos(static_cast<const unsigned char*>( record ))
+	{
+	}
+
+	template<class T>
+	T Read()
+	{
+		T value;
+		memcpy( &value, m_pos, sizeof value );
+		m_pos += sizeof value;
+
+		return value;
+	}
+
+	const char *ReadString()
+	{
+		const char *string = reinterpret_cast<const char*>( m_pos );
+		m_pos += strlen( string ) + 1;
+
+		return string;
+	}
+};
+
+static bool CaptureString( RecordWriter & writer, const char *string, const FormatSpec & spec, int precision )
+{
+	if ( ! string )
+	{
+		string = "";
+	}
+
+	size_t length = 0;
+
+	if ( spec.hasPrecision )
+	{
+		const size_t maxLength = (precision > 0) ? precision : 0;
+
+		// the string doesn't have to be null-terminated in this case
+		while ( length < maxLength && string[length] )
+		{
+			length++;
+		}
+	}
+	else
+	{
+		length = strlen( string );
+	}
+
+	const char terminator = '\0';
+
+	return writer.Write( string, length ) && writer.Write( terminator );
+}
+
+/**
+ * @brief Copies the format string and all arguments to a record.
+ * This function can be called from any thread.
+ * @param record The record.
+ * @param recordSize Size of the record in bytes.
+ * @param format The format string.
+ * @param args The arguments. They're consumed, so pass a copy if they're needed later.
+ * @return Used size of the record or zero if the record is too small.
+ */
+size_t LogArgs::Capture( void *record, size_t recordSize, const char *format, va_list args )
+{
+	RecordWriter writer( record, recordSize );
+
+	if ( ! writer.Write( format, strlen( format ) + 1 ) )
+	{
+		return 0;
+	}
+
+	while ( *format )
+	{
+		if ( *format != '%' )
+		{
+			format++;
+			continue;
+		}
+
+		FormatSpec spec;
+		format = ParseSpec( format, spec );
+
+		if ( ! spec.isComplete || spec.length >= LOG_ARGS_MAX_SPEC_LENGTH )
+		{
+			return 0;
+		}
+
+		int precision = spec.precision;
+
+		for ( int i = 0; i < spec.starCount; i++ )
+		{
+			const int value = va_arg( args, int );
+
+			if ( ! writer.Write( value ) )
+			{
+				return 0;
+			}
+
+			if ( spec.isPrecisionStar && i == spec.starCount - 1 )
+			{
+				precision = value;
+			}
+		}
+
+		bool isOK = true;
+
+		switch ( spec.type )
+		{
+			case eAT_None:     break;
+			case eAT_Int:      isOK = writer.Write( va_arg( args, int ) );         break;
+			case eAT_Long:     isOK = writer.Write( va_arg( args, long ) );        break;
+			case eAT_LongLong: isOK = writer.Write( va_arg( args, long long ) );   break;
+			case eAT_Double:   isOK = writer.Write( va_arg( args, double ) );      break;
+			case eAT_Pointer:  isOK = writer.Write( va_arg( args, void* ) );       break;
+			case eAT_String:   isOK = CaptureString( writer, va_arg( args, const char* ), spec, precision ); break;
+		}
+
+		if ( ! isOK )
+		{
+			return 0;
+		}
+	}
+
+	return writer.GetPos() - static_cast<unsigned char*>( record );
+}
+
+template<class T>
+static int FormatValue( char *buffer, size_t bufferSize, const char *spec, const int *stars, int starCount, T value )
+{
+	switch ( starCount )
+	{
+		case 1: return snprintf_( buffer, bufferSize, spec, stars[0], value );
+		case 2: return snprintf_( buffer, bufferSize, spec, stars[0], stars[1], value );
+	}
+
+	return snprintf_( buffer, bufferSize, spec, value );
+}
+
+/**
+ * @brief Formats a record created by Capture.
+ * The result is the same as vsnprintf_ with the original format string and arguments, except that NULL strings are
+ * formatted as empty strings. vsnprintf_ would crash on them.
+ * @param record The record.
+ * @param buffer Output buffer. Can be NULL if bufferSize is zero.
+ * @param bufferSize Size of the output buffer including the null terminator.
+ * @return Length of the whole formatted message. The output is truncated if it's not less than bufferSize.
+ */
+size_t LogArgs::Format( const void *record, char *buffer, size_t bufferSize )
+{
+	RecordReader reader( record );
+
+	const char *format = reader.ReadString();
+
+	size_t length = 0;
+
+	while ( *format )
+	{
+		if ( *format != '%' )
+		{
+			if ( length + 1 < bufferSize )
+			{
+				buffer[length] = *format;
+			}
+
+			length++;
+			format++;
+			continue;
+		}
+
+		FormatSpec spec;
+		format = ParseSpec( format, spec );
+
+		char specBuffer[LOG_ARGS_MAX_SPEC_LENGTH];
+		memcpy( specBuffer, spec.begin, spec.length );
+		specBuffer[spec.length] = '\0';
+
+		int stars[2];
+		for ( int i = 0; i < spec.starCount; i++ )
+		{
+			stars[i] = reader.Read<int>();
+		}
+
+		char *pos = (length < bufferSize) ? buffer + length : NULL;
+		const size_t available = (length < bufferSize) ? bufferSize - length : 0;
+
+		int status = 0;
+
+		switch ( spec.type )
+		{
+			case eAT_None:
+			{
+				status = FormatValue( pos, available, specBuffer, stars, spec.starCount, 0 );
+				break;
+			}
+			case eAT_Int:
+			{
+				status = FormatValue( pos, available, specBuffer, stars, spec.starCount, reader.Read<int>() );
+				break;
+			}
+			case eAT_Long:
+			{
+				status = FormatValue( pos, available, specBuffer, stars, spec.starCount, reader.Read<long>() );
+				break;
+			}
+			case eAT_LongLong:
+			{
+				status = FormatValue( pos, available, specBuffer, stars, spec.starCount, reader.Read<long long>() );
+				break;
+			}
+			case eAT_Double:
+			{
+				status = FormatValue( pos, available, specBuffer, stars, spec.starCount, reader.Read<double>() );
+				break;
+			}
+			case eAT_Pointer:
+			{
+				status = FormatValue( pos, available, specBuffer, stars, spec.starCount, reader.Read<void*>() );
+				break;
+			}
+			case eAT_String:
+			{
+				status = FormatValue( pos, available, specBuffer, stars, spec.starCount, reader.ReadString() );
+				break;
+			}
+		}
+
+		if ( status > 0 )
+		{
+			length += status;
+		}
+	}
+
+	if ( bufferSize > 0 )
+	{
+		buffer[(length < bufferSize) ? length : bufferSize - 1] = '\0';
+	}
+
+	return length;
+}
@@ -0,0 +1,15 @@
+/**
+ * @file
+ * @brief Capturing of log message arguments for deferred formatting.
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include <stdarg.h>
+
+namespace LogArgs
+{
+	size_t Capture( void *record, size_t recordSize, const char *format, va_list args );
+	size_t Format( const void *record, char *buffer, size_t bufferSize );
+}
@@ -0,0 +1,207 @@
+/**
+ * @file
+ * @brief Implementation of log flood suppression.
+ */
+
+#include <string.h>
+
+// Launcher headers
+#include "LogFloodFilter.h"
+#include "Clock.h"
+
+/**
+ * @brief FNV-1a hash of the message and its type.
+ */
+static unsigned long long HashMessage( int type, const char *text, size_t length )
+{
+	unsigned long long hash = 14695981039346656037ULL;
+
+	hash ^= static_cast<unsigned char>( type );
+	hash *= 1099511628211ULL;
+
+	for ( size_t i = 0; i < length; i++ )
+	{
+		hash ^= static_cast<unsigned char>( text[i] );
+		hash *= 1099511628211ULL;
+	}
+
+	return hash;
+}
+
+LogFloodFilter::LogFloodFilter()
+: m_collapseWindow(0),
+  m_limit(0),
+  m_burst(0),
+  m_totalCollapsedCount(0),
+  m_totalLimitedCount(0)
+{
+	memset( m_table, 0, sizeof m_table );
+	memset( m_buckets, 0, sizeof m_buckets );
+}
+
+/**
+ * @brief Sets how long repeats of a message are collapsed after the message is logged.
+ * @param seconds The time window. Zero disables collapsing of repeated messages.
+ */
+void LogFloodFilter::SetCollapseWindow( double seconds )
+{
+	m_collapseWindow = (seconds > 0) ? Clock::SecondsToTicks( seconds ) : 0;
+}
+
+/**
+ * @brief Sets token bucket parameters used separately for each message type.
+ * @param limit Maximum average number of messages per second. Zero disables the limit.
+ * @param burst Maximum number of messages logged at once.
+ */
+void LogFloodFilter::SetRateLimit( double limit, double burst )
+{
+	m_limit = (limit > 0) ? limit : 0;
+	m_burst = (burst > 1) ? burst : 1;
+
+	for ( int i = 0; i < LOG_FLOOD_TYPE_COUNT; i++ )
+	{
+		m_buckets[i].tokens = m_burst;
+	}
+}
+
+bool LogFloodFilter::IsCollapsed( int type, const char *text, size_t length, long long time )
+{
+	const unsigned long long hash = HashMessage( type, text, length );
+
+	Entry & entry = m_table[hash % LOG_FLOOD_TABLE_SIZE];
+
+	if ( entry.isUsed && entry.hash == hash && entry.length == length && (time - entry.firstTime) < m_collapseWindow )
+	{
+		entry.count++;
+		m_totalCollapsedCount++;
+
+		return true;
+	}
+
+	// suppressed repeats of the previous message are reported first
+	if ( ! entry.isUsed || entry.count == 0 )
+	{
+		const size_t textLength = (length < sizeof entry.text) ? length : sizeof entry.text - 1;
+
+		entry.hash = hash;
+		entry.length = length;
+		entry.firstTime = time;
+		entry.count = 0;
+		entry.type = type;
+		entry.isUsed = true;
+
+		memcpy( entry.text, text, textLength );
+		entry.text[textLength] = '\0';
+	}
+
+	return false;
+}
+
+bool LogFloodFilter::IsLimited( int type, long long time )
+{
+	Bucket & bucket = m_buckets[type];
+
+	// messages from other threads may be older than the last one
+	if ( time > bucket.lastTime )
+	{
+		bucket.tokens += Clock::TicksToSeconds( time - bucket.lastTime ) * m_limit;
+
+		if ( bucket.tokens > m_burst )
+		{
+			bucket.tokens = m_burst;
+		}
+
+		bucket.lastTime = time;
+	}
+
+	if ( bucket.tokens >= 1 )
+	{
+		bucket.tokens -= 1;
+		return false;
+	}
+
+	bucket.limitedCount++;
+	m_totalLimitedCount++;
+
+	return true;
+}
+
+/**
+ * @brief Checks if a message should be logged.
+ * @param type Type of the message.
+ * @param text The message.
+ * @param length Length of the message.
+ * @param time Clock value when the message was logged.
+ * @return True if the message should be logged, otherwise false.
+ */
+bool LogFloodFilter::Check( int type, const char *text, size_t length, long long time )
+{
+	if ( type < 0 || type >= LOG_FLOOD_TYPE_COUNT )
+	{
+		return true;
+	}
+
+	if ( m_collapseWindow > 0 && IsCollapsed( type, text, length, time ) )
+	{
+		return false;
+	}
+
+	if ( m_limit > 0 && IsLimited( type, time ) )
+	{
+		return false;
+	}
+
+	return true;
+}
+
+/**
+ * @brief Reports suppressed messages.
+ * Repeated messages are reported when their time window elapses. Rate-limited messages are reported once per second.
+ * @param time The current clock value.
+ * @param reportFunc Function called for each report.
+ * @param param Parameter passed to the function.
+ */
+void LogFloodFilter::Update( long long time, TReportFunc reportFunc, void *param )
+{
+	for ( int i = 0; i < LOG_FLOOD_TABLE_SIZE; i++ )
+	{
+		Entry & entry = m_table[i];
+
+		if ( entry.isUsed && (time - entry.firstTime) >= m_collapseWindow )
+		{
+			if ( entry.count > 0 )
+			{
+				Report report;
+				report.type = entry.type;
+				report.count = entry.count;
+				report.isRepeat = true;
+				report.text = entry.text;
+
+				reportFunc( report, param );
+			}
+
+			entry.isUsed = false;
+		}
+	}
+
+	const long long reportInterval = Clock::GetFrequency();
+
+	for ( int i = 0; i < LOG_FLOOD_TYPE_COUNT; i++ )
+	{
+		Bucket & bucket = m_buckets[i];
+
+		if ( bucket.limitedCount > 0 && (time - bucket.lastReportTime) >= reportInterval )
+		{
+			Report report;
+			report.type = i;
+			report.count = bucket.limitedCount;
+			report.isRepeat = false;
+			report.text = "";
+
+			reportFunc( report, param );
+
+			bucket.limitedCount = 0;
+			bucket.lastReportTime = time;
+		}
+	}
+}
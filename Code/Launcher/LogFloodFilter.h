@@ -0,0 +1,85 @@
+/**
+ * @file
+ * @brief Log flood suppression.
+ */
+
+#pragma once
+
+#include <stddef.h>
+
+#define LOG_FLOOD_TYPE_COUNT 16
+#define LOG_FLOOD_TABLE_SIZE 64
+#define LOG_FLOOD_TEXT_SIZE 128
+
+/**
+ * @brief Collapses repeated log messages and limits rate of log messages of each type.
+ * All functions must be called only from main thread.
+ */
+class LogFloodFilter
+{
+public:
+	/**
+	 * @brief Information about suppressed messages.
+	 */
+	struct Report
+	{
+		int type;
+		unsigned long count;
+		bool isRepeat;     //!< Repeated message or rate limit.
+		const char *text;  //!< Beginning of the repeated message. Empty in case of rate limit.
+	};
+
+	typedef void (*TReportFunc)( const Report & report, void *param );
+
+private:
+	struct Entry
+	{
+		unsigned long long hash;
+		size_t length;
+		long long firstTime;
+		unsigned long count;
+		int type;
+		bool isUsed;
+		char text[LOG_FLOOD_TEXT_SIZE];
+	};
+
+	struct Bucket
+	{
+		double tokens;
+		long long lastTime;
+		long long lastReportTime;
+		unsigned long limitedCount;
+	};
+
+	Entry m_table[LOG_FLOOD_TABLE_SIZE];
+	Bucket m_buckets[LOG_FLOOD_TYPE_COUNT];
+
+	long long m_collapseWindow;  //!< Clock ticks.
+	double m_limit;              //!< Messages per second.
+	double m_burst;
+
+	unsigned long m_totalCollapsedCount;
+	unsigned long m_totalLimitedCount;
+
+	bool IsCollapsed( int type, const char *text, size_t length, long long time );
+	bool IsLimited( int type, long long time );
+
+public:
+	LogFloodFilter();
+
+	void SetCollapseWindow( double seconds );
+	void SetRateLimit( double limit, double burst );
+
+	bool Check( int type, const char *text, size_t length, long long time );
+	void Update( long long time, TReportFunc reportFunc, void *param );
+
+	unsigned long GetTotalCollapsedCount() const
+	{
+		return m_totalCollapsedCount;
+	}
+
+	unsigned long GetTotalLimitedCount() const
+	{
+		return m_totalLimitedCount;
+	}
+};
@@ -0,0 +1,238 @@
+/**
+ * @file
+ * @brief Implementation of fixed-size in-memory ring of recent log lines.
+ */
+
+#include <string.h>
+
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+
+// Launcher headers
+#include "LogRing.h"
+
+#define LOG_RING_SLOT_SIZE 512
+
+/**
+ * @brief One line in the ring.
+ * Each slot is protected by its own sequence lock, so the writer never waits for readers. Readers copy the slot and
+ * then check that its version didn't change in the meantime.
+ */
+struct LogRing::Slot
+{
+	volatile long version;  //!< Odd while the slot is being written.
+	unsigned int length;
+	unsigned long long seq;
+	char text[LOG_RING_SLOT_SIZE - sizeof (long) - sizeof (unsigned int) - sizeof (unsigned long long)];
+};
+
+/**
+ * @brief Constructor.
+ * No memory is allocated until Init is called.
+ */
+LogRing::LogRing()
+: m_slots(NULL),
+  m_slotCount(0),
+  m_nextSeq(1),
+  m_nextSeqVersion(0)
+{
+}
+
+LogRing::~LogRing()
+{
+	if ( m_slots )
+	{
+		VirtualFree( m_slots, 0, MEM_RELEASE );
+	}
+}
+
+/**
+ * @brief Allocates the ring.
+ * @param lineCount Maximum number of lines in the ring. Longer lines are truncated to fit into fixed-size slots.
+ * @return True if no error occurred, otherwise false.
+ */
+bool LogRing::Init( size_t lineCount )
+{
+	if ( m_slots || lineCount == 0 )
+	{
+		return false;
+	}
+
+	// zero-initialized memory
+	m_slots = static_cast<Slot*>( VirtualAlloc( NULL, lineCount * sizeof (Slot), MEM_COMMIT | MEM_RESERVE, PAGE_READWRITE ) );
+	if ( ! m_slots )
+	{
+		return false;
+	}
+
+	m_slotCount = lineCount;
+
+	return true;
+}
+
+unsigned long long LogRing::GetNextSeq() const
+{
+	unsigned long long nextSeq;
+	long version;
+
+	do
+	{
+		version = m_nextSeqVersion;
+		MemoryBarrier();
+		nextSeq = m_nextSeq;
+		MemoryBarrier();
+	}
+	while ( (version & 1) || version != m_nextSeqVersion );
+
+	return nextSeq;
+}
+
+/**
+ * @brief Adds a new line to the ring and overwrites the oldest one if the ring is full.
+ * This function must be called only from a single thread.
+ * @param text The line without new line characters.
+ * @param length Length of the line.
+ */
+void LogRing::Push( const char *text, size_t length )
+{
+	if ( ! m_slots )
+	{
+		return;
+	}
+
+	const unsigned long long seq = m_nextSeq;
+	Slot & slot = m_slots[seq % m_slotCount];
+
+	if ( length > sizeof slot.text )
+	{
+		length = sizeof slot.text;
+	}
+
+	InterlockedIncrement( &slot.version );
+
+	slot.seq = seq;
+	slot.length = static_cast<unsigned int>( length );
+	memcpy( slot.text, text, length );
+
+	InterlockedIncrement( &slot.version );
+
+	InterlockedIncrement( &m_nextSeqVersion );
+	m_nextSeq = seq + 1;
+	InterlockedIncrement( &m_nextSeqVersion );
+}
+
+/**
+ * @brief Copies lines from the ring.
+ * This function can be called from any thread. Lines overwritten during copying are skipped.
+ * @param seq Sequence number of the first requested line. Lines are numbered from 1. Older lines than the oldest one in
+ * the ring are skipped.
+ * @param buffer Output buffer. Each line is terminated by a new line character. No null terminator is added.
+ * @param bufferSize Size of the output buffer. Only whole lines are copied.
+ * @param pFirstSeq Receives sequence number of the first copied line. Can be NULL.
+ * @param pNextSeq Receives sequence number of the first line that wasn't copied. Can be NULL.
+ * @return Number of bytes copied to the output buffer.
+ */
+size_t LogRing::Copy( unsigned long long seq, char *buffer, size_t bufferSize, unsigned long long *pFirstSeq,
+                      unsigned long long *pNextSeq ) const
+{
+	size_t totalLength = 0;
+	unsigned long long firstSeq = 0;
+
+	const unsigned long long nextSeq = (m_slots) ? GetNextSeq() : 1;
+
+	if ( m_slots )
+	{
+		const unsigned long long oldestSeq = (nextSeq > m_slotCount) ? nextSeq - m_slotCount : 1;
+
+		if ( seq < oldestSeq )
+		{
+			seq = oldestSeq;
+		}
+
+		for ( ; seq < nextSeq; seq++ )
+		{
+			const Slot & slot = m_slots[seq % m_slotCount];
+
+			const long version = slot.version;
+			MemoryBarrier();
+
+			if ( version & 1 )
+			{
+				// the line is being overwritten
+				continue;
+			}
+
+			const size_t length = slot.length;
+
+			if ( length > sizeof slot.text )
+			{
+				// the line is being overwritten
+				continue;
+			}
+
+			if ( totalLength + length + 1 > bufferSize )
+			{
+				MemoryBarrier();
+
+				if ( slot.seq == seq && version == slot.version )
+				{
+					// no space left for this line
+					break;
+				}
+
+				continue;
+			}
+
+			memcpy( buffer + totalLength, slot.text, length );
+
+			MemoryBarrier();
+
+			if ( slot.seq != seq || version != slot.version )
+			{
+				// the line was overwritten while being copied
+				continue;
+			}
+
+			if ( firstSeq == 0 )
+			{
+				firstSeq = seq;
+			}
+
+			totalLength += length;
+			buffer[totalLength++] = '\n';
+		}
+	}
+
+	if ( pFirstSeq )
+	{
+		*pFirstSeq = firstSeq;
+	}
+
+	if ( pNextSeq )
+	{
+		*pNextSeq = (m_slots) ? seq : nextSeq;
+	}
+
+	return totalLength;
+}
+
+/**
+ * @brief Copies the most recent lines from the ring.
+ * This function can be called from any thread.
+ * @param lineCount Maximum number of lines.
+ * @param buffer Output buffer. Each line is terminated by a new line character. No null terminator is added.
+ * @param bufferSize Size of the output buffer. Only whole lines are copied, so the newest lines can be missing.
+ * @return Number of bytes copied to the output buffer.
+ */
+size_t LogRing::CopyLast( size_t lineCount, char *buffer, size_t bufferSize ) const
+{
+	if ( ! m_slots )
+	{
+		return 0;
+	}
+
+	const unsigned long long nextSeq = GetNextSeq();
+	const unsigned long long seq = (nextSeq > lineCount) ? nextSeq - lineCount : 1;
+
+	return Copy( seq, buffer, bufferSize, NULL, NULL );
+}
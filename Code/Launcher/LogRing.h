@@ -0,0 +1,47 @@
+/**
+ * @file
+ * @brief Fixed-size in-memory ring of recent log lines.
+ */
+
+#pragma once
+
+#include <stddef.h>
+
+class LogRing
+{
+	struct Slot;
+
+	Slot *m_slots;
+	size_t m_slotCount;
+
+	unsigned long long m_nextSeq;
+	volatile long m_nextSeqVersion;
+
+	// disable implicit copy constructor and copy assignment operator
+	LogRing( const LogRing & );
+	LogRing & operator=( const LogRing & );
+
+	unsigned long long GetNextSeq() const;
+
+public:
+	LogRing();
+	~LogRing();
+
+	bool Init( size_t lineCount );
+
+	bool IsEnabled() const
+	{
+		return m_slots != NULL;
+	}
+
+	size_t GetLineCount() const
+	{
+		return m_slotCount;
+	}
+
+	void Push( const char *text, size_t length );
+
+	size_t Copy( unsigned long long seq, char *buffer, size_t bufferSize, unsigned long long *pFirstSeq,
+	             unsigned long long *pNextSeq ) const;
+	size_t CopyLast( size_t lineCount, char *buffer, size_t bufferSize ) const;
+};
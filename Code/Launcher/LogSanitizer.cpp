@@ -0,0 +1,170 @@
+/**
+ * @file
+ * @brief Implementation of removal of control characters and color codes from log messages.
+ */
+
+#include <emmintrin.h>  // SSE2
+#ifdef _MSC_VER
+#include <intrin.h>     // _BitScanForward
+#endif
+
+// Launcher headers
+#include "LogSanitizer.h"
+#include "CPU.h"
+
+static bool IsControlChar( char c )
+{
+	// note that char is signed, so any non-ASCII characters are treated as control characters too
+	return c < 32 || c == 127;
+}
+
+static unsigned long FindFirstBit( int mask )
+{
+#ifdef _MSC_VER
+	unsigned long pos;
+	_BitScanForward( &pos, mask );
+	return pos;
+#else
+	return __builtin_ctz( mask );
+#endif
+}
+
+/**
+ * @brief Processes one character that isn't copied as it is.
+ * @return Number of processed characters in the source.
+ */
+static size_t ProcessSpecialChar( char *dest, size_t & destLength, const char *src, size_t remainingLength )
+{
+	if ( src[0] == '$' )
+	{
+		// convert "$$" to "$"
+		if ( remainingLength > 1 && src[1] == '$' )
+		{
+			dest[destLength++] = '$';
+		}
+
+		// skip color codes
+		return 2;
+	}
+	else
+	{
+		// skip control characters
+		return 1;
+	}
+}
+
+/**
+ * @brief Scalar implementation of Sanitize.
+ */
+size_t LogSanitizer::SanitizeScalar( char *dest, const char *src, size_t length, bool stripColorCodes )
+{
+	size_t destLength = 0;
+
+	for ( size_t i = 0; i < length; )
+	{
+		const char c = src[i];
+
+		if ( IsControlChar( c ) || (c == '$' && stripColorCodes) )
+		{
+			i += ProcessSpecialChar( dest, destLength, src + i, length - i );
+		}
+		else
+		{
+			dest[destLength++] = c;
+			i++;
+		}
+	}
+
+	return destLength;
+}
+
+/**
+ * @brief SSE2 implementation of Sanitize.
+ * The processor must support SSE2.
+ */
+size_t LogSanitizer::SanitizeSSE2( char *dest, const char *src, size_t length, bool stripColorCodes )
+{
+	const __m128i space = _mm_set1_epi8( 32 );
+	const __m128i del = _mm_set1_epi8( 127 );
+	const __m128i dollar = _mm_set1_epi8( (stripColorCodes) ? '$' : 127 );
+
+	size_t destLength = 0;
+	size_t i = 0;
+
+	while ( i + 16 <= length )
+	{
+		const __m128i chars = _mm_loadu_si128( reinterpret_cast<const __m128i*>( src + i ) );
+
+		// signed comparison treats any non-ASCII characters as control characters like the scalar version
+		__m128i special = _mm_cmplt_epi8( chars, space );
+		special = _mm_or_si128( special, _mm_cmpeq_epi8( chars, del ) );
+		special = _mm_or_si128( special, _mm_cmpeq_epi8( chars, dollar ) );
+
+		const int mask = _mm_movemask_epi8( special );
+
+		// the destination is never ahead of the source, so storing whole 16 bytes is always safe
+		_mm_storeu_si128( reinterpret_cast<__m128i*>( dest + destLength ), chars );
+
+		if ( mask == 0 )
+		{
+			destLength += 16;
+			i += 16;
+		}
+		else
+		{
+			const unsigned long specialPos = FindFirstBit( mask );
+
+			destLength += specialPos;
+			i += specialPos;
+
+			i += ProcessSpecialChar( dest, destLength, src + i, length - i );
+		}
+	}
+
+	if ( i < length )
+	{
+		destLength += SanitizeScalar( dest + destLength, src + i, length - i, stripColorCodes );
+	}
+
+	return destLength;
+}
+
+static bool HasSSE2()
+{
+#ifdef BUILD_64BIT
+	// SSE2 is part of x86_64
+	return true;
+#else
+	static int hasSSE2 = -1;  // the check is idempotent, so concurrent initialization is harmless
+
+	if ( hasSSE2 < 0 )
+	{
+		hasSSE2 = (CPU::HasSSE2()) ? 1 : 0;
+	}
+
+	return hasSSE2 > 0;
+#endif
+}
+
+/**
+ * @brief Removes control characters and optionally also Crysis color codes from a log message in a single pass.
+ * Non-ASCII characters are treated as control characters and "$$" is converted to "$" if color codes are removed.
+ * SSE2 is used if the processor supports it.
+ * @param dest Destination buffer. It must be at least as large as the source and must not overlap it.
+ * The result isn't null-terminated.
+ * @param src The message.
+ * @param length Length of the message.
+ * @param stripColorCodes True if color codes should be removed as well.
+ * @return Length of the sanitized message in the destination buffer.
+ */
+size_t LogSanitizer::Sanitize( char *dest, const char *src, size_t length, bool stripColorCodes )
+{
+	if ( HasSSE2() )
+	{
+		return SanitizeSSE2( dest, src, length, stripColorCodes );
+	}
+	else
+	{
+		return SanitizeScalar( dest, src, length, stripColorCodes );
+	}
+}
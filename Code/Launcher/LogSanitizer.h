@@ -0,0 +1,17 @@
+/**
+ * @file
+ * @brief Removal of control characters and color codes from log messages.
+ */
+
+#pragma once
+
+#include <stddef.h>
+
+namespace LogSanitizer
+{
+	size_t Sanitize( char *dest, const char *src, size_t length, bool stripColorCodes );
+
+	// both implementations are available for testing
+	size_t SanitizeScalar( char *dest, const char *src, size_t length, bool stripColorCodes );
+	size_t SanitizeSSE2( char *dest, const char *src, size_t length, bool stripColorCodes );
+}
@@ -0,0 +1,715 @@
+/**
+ * @file
+ * @brief Implementation of log file writer.
+ */
+
+#include <string.h>
+
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+
+// Launcher headers
+#include "LogWriter.h"
+
+#define LOG_WRITER_BUFFER_SIZE (64 * 1024)
+
+class LogWriter::Impl
+{
+	struct RecordHeader
+	{
+		unsigned int length;
+		unsigned int flags;
+	};
+
+	enum ERecordFlags
+	{
+		RECORD_APPEND = (1 << 0),
+		RECORD_FLUSH  = (1 << 1)
+	};
+
+	HANDLE m_hFile;
+	HANDLE m_hThread;
+	HANDLE m_hDataEvent;   //!< Auto-reset event signaled when new data is queued.
+	HANDLE m_hSpaceEvent;  //!< Manual-reset event signaled when some space in the queue is released.
+	HANDLE m_hIdleEvent;   //!< Manual-reset event signaled when the queue is empty and everything is written.
+	CRITICAL_SECTION m_criticalSection;
+
+	char *m_queue;
+	size_t m_queueSize;
+	size_t m_queueReadPos;
+	size_t m_queueUsedSize;
+	bool m_isStopRequested;
+	bool m_isFlushRequested;
+	bool m_isDropOldest;
+	volatile LONG m_droppedCount;
+
+	char *m_batch;
+	size_t m_batchLength;
+
+	// write-combining buffer owned by the writer thread or by the producer if there is no writer thread
+	char *m_buffer;
+	size_t m_bufferLength;
+	DWORD m_bufferTime;  //!< When the oldest buffered data were added.
+	volatile LONG m_flushInterval;
+
+	static DWORD WINAPI ThreadProc( LPVOID param );
+
+	void ThreadLoop();
+	void PopBatch();
+	void ProcessBatch();
+
+	void CopyToQueue( size_t pos, const void *data, size_t length );
+	void CopyFromQueue( size_t pos, void *data, size_t length ) const;
+	void DropOldestRecord();
+
+	void Output( const char *data, size_t length, unsigned int flags );
+	void WriteToFile( const char *data, size_t length );
+	void FlushBuffer();
+	bool IsFlushTime() const;
+	DWORD GetTimeToFlush() const;
+
+public:
+	Impl()
+	: m_hFile(NULL),
+	  m_hThread(NULL),
+	  m_hDataEvent(NULL),
+	  m_hSpaceEvent(NULL),
+	  m_hIdleEvent(NULL),
+	  m_criticalSection(),
+	  m_queue(NULL),
+	  m_queueSize(0),
+	  m_queueReadPos(0),
+	  m_queueUsedSize(0),
+	  m_isStopRequested(false),
+	  m_isFlushRequested(false),
+	  m_isDropOldest(false),
+	  m_droppedCount(0),
+	  m_batch(NULL),
+	  m_batchLength(0),
+	  m_buffer(new char[LOG_WRITER_BUFFER_SIZE]),
+	  m_bufferLength(0),
+	  m_bufferTime(0),
+	  m_flushInterval(0)
+	{
+		InitializeCriticalSection( &m_criticalSection );
+	}
+
+	~Impl()
+	{
+		StopThread();
+		FlushBuffer();
+
+		DeleteCriticalSection( &m_criticalSection );
+
+		delete [] m_buffer;
+	}
+
+	HANDLE GetFile() const
+	{
+		return m_hFile;
+	}
+
+	void SetFile( HANDLE hFile )
+	{
+		Flush();
+
+		m_hFile = hFile;
+	}
+
+	void SetFlushInterval( unsigned int flushInterval )
+	{
+		InterlockedExchange( &m_flushInterval, flushInterval );
+
+		if ( m_hThread )
+		{
+			// wake up the writer thread to use the new interval
+			SetEvent( m_hDataEvent );
+		}
+	}
+
+	void SetDropOldest( bool isDropOldest )
+	{
+		EnterCriticalSection( &m_criticalSection );
+		m_isDropOldest = isDropOldest;
+		LeaveCriticalSection( &m_criticalSection );
+
+		if ( isDropOldest && m_hSpaceEvent )
+		{
+			// wake up any blocked producer
+			SetEvent( m_hSpaceEvent );
+		}
+	}
+
+	bool IsThreadRunning() const
+	{
+		return m_hThread != NULL;
+	}
+
+	long GetDroppedCount() const
+	{
+		return m_droppedCount;
+	}
+
+	bool StartThread( size_t queueSize );
+	bool StopThread( DWORD timeout = INFINITE );
+
+	void Write( const char *data, size_t length, bool isAppend, bool isFlush );
+	void Update();
+	void Flush();
+};
+
+DWORD WINAPI LogWriter::Impl::ThreadProc( LPVOID param )  // static function
+{
+	static_cast<Impl*>( param )->ThreadLoop();
+
+	return 0;
+}
+
+void LogWriter::Impl::ThreadLoop()
+{
+	for (;;)
+	{
+		EnterCriticalSection( &m_criticalSection );
+
+		if ( m_queueUsedSize == 0 )
+		{
+			const bool isStopRequested = m_isStopRequested;
+			const bool isFlushRequested = m_isFlushRequested;
+			m_isFlushRequested = false;
+
+			LeaveCriticalSection( &m_criticalSection );
+
+			if ( isStopRequested || isFlushRequested || IsFlushTime() )
+			{
+				FlushBuffer();
+			}
+
+			EnterCriticalSection( &m_criticalSection );
+
+			// check again because some data may have been queued meanwhile
+			if ( m_queueUsedSize == 0 && m_bufferLength == 0 )
+			{
+				SetEvent( m_hIdleEvent );
+			}
+
+			LeaveCriticalSection( &m_criticalSection );
+
+			if ( isStopRequested )
+			{
+				// everything is written
+				break;
+			}
+
+			WaitForSingleObject( m_hDataEvent, GetTimeToFlush() );
+		}
+		else
+		{
+			PopBatch();
+
+			LeaveCriticalSection( &m_criticalSection );
+
+			// wake up any blocked producer
+			SetEvent( m_hSpaceEvent );
+
+			ProcessBatch();
+		}
+	}
+}
+
+/**
+ * @brief Moves as many queued records as possible to the batch buffer.
+ * The lock must be held by the caller.
+ */
+void LogWriter::Impl::PopBatch()
+{
+	const size_t length = m_queueUsedSize;
+
+	CopyFromQueue( m_queueReadPos, m_batch, length );
+	m_batchLength = length;
+
+	m_queueReadPos = (m_queueReadPos + length) % m_queueSize;
+	m_queueUsedSize = 0;
+}
+
+void LogWriter::Impl::ProcessBatch()
+{
+	size_t pos = 0;
+
+	while ( pos < m_batchLength )
+	{
+		RecordHeader header;
+		memcpy( &header, m_batch + pos, sizeof header );
+		pos += sizeof header;
+
+		Output( m_batch + pos, header.length, header.flags );
+		pos += header.length;
+	}
+
+	m_batchLength = 0;
+
+	if ( IsFlushTime() )
+	{
+		FlushBuffer();
+	}
+}
+
+void LogWriter::Impl::CopyToQueue( size_t pos, const void *data, size_t length )
+{
+	pos %= m_queueSize;
+
+	const size_t firstLength = (pos + length > m_queueSize) ? m_queueSize - pos : length;
+
+	memcpy( m_queue + pos, data, firstLength );
+	memcpy( m_queue, static_cast<const char*>( data ) + firstLength, length - firstLength );
+}
+
+void LogWriter::Impl::CopyFromQueue( size_t pos, void *data, size_t length ) const
+{
+	pos %= m_queueSize;
+
+	const size_t firstLength = (pos + length > m_queueSize) ? m_queueSize - pos : length;
+
+	memcpy( data, m_queue + pos, firstLength );
+	memcpy( static_cast<char*>( data ) + firstLength, m_queue, length - firstLength );
+}
+
+/**
+ * @brief Releases the oldest queued record to make space for new data.
+ * The lock must be held by the caller.
+ */
+void LogWriter::Impl::DropOldestRecord()
+{
+	RecordHeader header;
+	CopyFromQueue( m_queueReadPos, &header, sizeof header );
+
+	const size_t recordSize = sizeof header + header.length;
+
+	m_queueReadPos = (m_queueReadPos + recordSize) % m_queueSize;
+	m_queueUsedSize -= recordSize;
+
+	InterlockedIncrement( &m_droppedCount );
+}
+
+/**
+ * @brief Adds data to the write-combining buffer.
+ * The buffer is written to the file when it's full, when the flush interval elapses, or when the data require it.
+ */
+void LogWriter::Impl::Output( const char *data, size_t length, unsigned int flags )
+{
+	if ( flags & RECORD_APPEND )
+	{
+		if ( m_bufferLength >= 2 )
+		{
+			// drop the last new line character from the buffered data
+			m_bufferLength -= 2;  // CRLF is 2 bytes long
+		}
+		else
+		{
+			FlushBuffer();
+
+			if ( m_hFile )
+			{
+				// move file pointer before the last new line character
+				SetFilePointer( m_hFile, -2, NULL, FILE_END );  // CRLF is 2 bytes long
+			}
+		}
+	}
+
+	if ( m_bufferLength + length > LOG_WRITER_BUFFER_SIZE )
+	{
+		FlushBuffer();
+	}
+
+	if ( length >= LOG_WRITER_BUFFER_SIZE )
+	{
+		WriteToFile( data, length );
+	}
+	else
+	{
+		if ( m_bufferLength == 0 )
+		{
+			m_bufferTime = GetTickCount();
+		}
+
+		memcpy( m_buffer + m_bufferLength, data, length );
+		m_bufferLength += length;
+	}
+
+	if ( (flags & RECORD_FLUSH) || IsFlushTime() )
+	{
+		FlushBuffer();
+	}
+}
+
+void LogWriter::Impl::WriteToFile( const char *data, size_t length )
+{
+	if ( ! m_hFile || length == 0 )
+	{
+		return;
+	}
+
+	DWORD bytesWritten;  // required
+	WriteFile( m_hFile, data, static_cast<DWORD>( length ), &bytesWritten, NULL );
+}
+
+void LogWriter::Impl::FlushBuffer()
+{
+	WriteToFile( m_buffer, m_bufferLength );
+
+	m_bufferLength = 0;
+}
+
+bool LogWriter::Impl::IsFlushTime() const
+{
+	return m_bufferLength > 0 && (GetTickCount() - m_bufferTime) >= static_cast<DWORD>( m_flushInterval );
+}
+
+/**
+ * @brief Returns how long the writer thread can wait before it has to flush the buffer.
+ */
+DWORD LogWriter::Impl::GetTimeToFlush() const
+{
+	if ( m_bufferLength == 0 )
+	{
+		return INFINITE;
+	}
+
+	const DWORD elapsedTime = GetTickCount() - m_bufferTime;
+	const DWORD flushInterval = m_flushInterval;
+
+	return (elapsedTime < flushInterval) ? flushInterval - elapsedTime : 0;
+}
+
+bool LogWriter::Impl::StartThread( size_t queueSize )
+{
+	if ( m_hThread )
+	{
+		return true;
+	}
+
+	// there must be space for at least one header with some data
+	if ( queueSize < 2 * sizeof (RecordHeader) )
+	{
+		queueSize = 2 * sizeof (RecordHeader);
+	}
+
+	m_hDataEvent = CreateEvent( NULL, FALSE, FALSE, NULL );
+	m_hSpaceEvent = CreateEvent( NULL, TRUE, FALSE, NULL );
+	m_hIdleEvent = CreateEvent( NULL, TRUE, TRUE, NULL );
+
+	if ( ! m_hDataEvent || ! m_hSpaceEvent || ! m_hIdleEvent )
+	{
+		StopThread();
+		return false;
+	}
+
+	m_queue = new char[queueSize];
+	m_queueSize = queueSize;
+	m_queueReadPos = 0;
+	m_queueUsedSize = 0;
+	m_isStopRequested = false;
+	m_isFlushRequested = false;
+
+	m_batch = new char[queueSize];
+	m_batchLength = 0;
+
+	m_hThread = CreateThread( NULL, 0, ThreadProc, this, 0, NULL );
+	if ( ! m_hThread )
+	{
+		StopThread();
+		return false;
+	}
+
+	return true;
+}
+
+/**
+ * @brief Stops the writer thread.
+ * All queued and buffered data are written before the thread exits.
+ * @return False if the thread is still running after the timeout, otherwise true.
+ */
+bool LogWriter::Impl::StopThread( DWORD timeout )
+{
+	if ( m_hThread )
+	{
+		EnterCriticalSection( &m_criticalSection );
+		m_isStopRequested = true;
+		LeaveCriticalSection( &m_criticalSection );
+
+		SetEvent( m_hDataEvent );
+
+		if ( WaitForSingleObject( m_hThread, timeout ) != WAIT_OBJECT_0 )
+		{
+			// the thread is probably blocked by the file, so everything must stay as it is
+			return false;
+		}
+
+		CloseHandle( m_hThread );
+		m_hThread = NULL;
+	}
+
+	if ( m_hDataEvent )
+	{
+		CloseHandle( m_hDataEvent );
+		m_hDataEvent = NULL;
+	}
+
+	if ( m_hSpaceEvent )
+	{
+		CloseHandle( m_hSpaceEvent );
+		m_hSpaceEvent = NULL;
+	}
+
+	if ( m_hIdleEvent )
+	{
+		CloseHandle( m_hIdleEvent );
+		m_hIdleEvent = NULL;
+	}
+
+	delete [] m_queue;
+	m_queue = NULL;
+	m_queueSize = 0;
+
+	delete [] m_batch;
+	m_batch = NULL;
+	m_batchLength = 0;
+
+	return true;
+}
+
+void LogWriter::Impl::Write( const char *data, size_t length, bool isAppend, bool isFlush )
+{
+	unsigned int flags = 0;
+
+	if ( isAppend )
+	{
+		flags |= RECORD_APPEND;
+	}
+
+	if ( isFlush )
+	{
+		flags |= RECORD_FLUSH;
+	}
+
+	if ( ! m_hThread )
+	{
+		Output( data, length, flags );
+		return;
+	}
+
+	// split data that don't fit into the queue, only the first record can be appended to the last line
+	const size_t maxRecordLength = m_queueSize - sizeof (RecordHeader);
+
+	do
+	{
+		RecordHeader header;
+		header.length = static_cast<unsigned int>( (length > maxRecordLength) ? maxRecordLength : length );
+		header.flags = flags;
+
+		const size_t recordSize = sizeof header + header.length;
+
+		if ( header.length < length )
+		{
+			// flush only after the last part
+			header.flags &= ~RECORD_FLUSH;
+		}
+
+		EnterCriticalSection( &m_criticalSection );
+
+		while ( m_queueSize - m_queueUsedSize < recordSize )
+		{
+			if ( m_isDropOldest )
+			{
+				// the queue is full, but the producer must not be blocked
+				DropOldestRecord();
+				continue;
+			}
+
+			// the queue is full, so wait for the writer thread
+			ResetEvent( m_hSpaceEvent );
+			LeaveCriticalSection( &m_criticalSection );
+
+			WaitForSingleObject( m_hSpaceEvent, INFINITE );
+
+			EnterCriticalSection( &m_criticalSection );
+		}
+
+		const size_t writePos = m_queueReadPos + m_queueUsedSize;
+
+		CopyToQueue( writePos, &header, sizeof header );
+		CopyToQueue( writePos + sizeof header, data, header.length );
+
+		m_queueUsedSize += recordSize;
+
+		ResetEvent( m_hIdleEvent );
+		LeaveCriticalSection( &m_criticalSection );
+
+		SetEvent( m_hDataEvent );
+
+		data += header.length;
+		length -= header.length;
+		flags &= ~RECORD_APPEND;
+	}
+	while ( length > 0 );
+}
+
+/**
+ * @brief Writes the buffered data if the flush interval has elapsed.
+ */
+void LogWriter::Impl::Update()
+{
+	// the writer thread takes care of this itself
+	if ( ! m_hThread && IsFlushTime() )
+	{
+		FlushBuffer();
+	}
+}
+
+/**
+ * @brief Waits until all queued and buffered data are written.
+ */
+void LogWriter::Impl::Flush()
+{
+	if ( m_hThread )
+	{
+		EnterCriticalSection( &m_criticalSection );
+		m_isFlushRequested = true;
+		ResetEvent( m_hIdleEvent );
+		LeaveCriticalSection( &m_criticalSection );
+
+		SetEvent( m_hDataEvent );
+
+		WaitForSingleObject( m_hIdleEvent, INFINITE );
+	}
+	else
+	{
+		FlushBuffer();
+	}
+}
+
+/**
+ * @brief Constructor.
+ */
+LogWriter::LogWriter()
+: m_impl(new Impl())
+{
+}
+
+/**
+ * @brief Destructor.
+ * Any queued and buffered data are written before the writer is destroyed.
+ */
+LogWriter::~LogWriter()
+{
+	delete m_impl;
+}
+
+/**
+ * @brief Sets the file handle used for writing.
+ * All data written so far are flushed to the previous file.
+ * This function can be called only from the thread that produces the data.
+ * @param hFile The file handle or NULL.
+ */
+void LogWriter::SetFile( void *hFile )
+{
+	m_impl->SetFile( static_cast<HANDLE>( hFile ) );
+}
+
+/**
+ * @brief Returns the current file handle.
+ */
+void *LogWriter::GetFile() const
+{
+	return m_impl->GetFile();
+}
+
+/**
+ * @brief Sets how long the written data can stay in the write-combining buffer.
+ * @param flushInterval Maximum time in milliseconds. Zero means that each write is passed to the file immediately.
+ */
+void LogWriter::SetFlushInterval( unsigned int flushInterval )
+{
+	m_impl->SetFlushInterval( flushInterval );
+}
+
+/**
+ * @brief Sets what happens when the queue of the background thread is full.
+ * @param isDropOldest True to drop the oldest queued data, false to block the producer until there is enough space.
+ */
+void LogWriter::SetDropOldest( bool isDropOldest )
+{
+	m_impl->SetDropOldest( isDropOldest );
+}
+
+/**
+ * @brief Starts a background thread that performs all file writes.
+ * Data buffered so far are written by the thread.
+ * @param queueSize Size of the bounded queue in bytes. Write blocks if the queue is full, unless the oldest data are
+ * dropped instead.
+ * @return True if the thread is running, otherwise false.
+ */
+bool LogWriter::StartThread( size_t queueSize )
+{
+	return m_impl->StartThread( queueSize );
+}
+
+/**
+ * @brief Stops the background thread.
+ * All queued and buffered data are written and any subsequent writes are done by the calling thread.
+ * @param timeout Maximum time in milliseconds to wait for the thread.
+ * @return False if the thread didn't finish in time. The writer must not be used or destroyed in that case.
+ */
+bool LogWriter::StopThread( unsigned long timeout )
+{
+	return m_impl->StopThread( timeout );
+}
+
+/**
+ * @brief Checks if the background thread is running.
+ */
+bool LogWriter::IsThreadRunning() const
+{
+	return m_impl->IsThreadRunning();
+}
+
+/**
+ * @brief Returns number of records dropped because the queue was full.
+ * Each call of Write creates one record unless the data don't fit into the queue.
+ */
+long LogWriter::GetDroppedCount() const
+{
+	return m_impl->GetDroppedCount();
+}
+
+/**
+ * @brief Writes data to the file.
+ * The data are queued if the background thread is running and then combined with other data in a buffer.
+ * @param data The data.
+ * @param length Length of the data in bytes.
+ * @param isAppend True if the data should replace the CRLF at the end of the file. Works also with buffered data.
+ * @param isFlush True if the data should be written to the file as soon as possible.
+ */
+void LogWriter::Write( const char *data, size_t length, bool isAppend, bool isFlush )
+{
+	if ( data && length > 0 )
+	{
+		m_impl->Write( data, length, isAppend, isFlush );
+	}
+}
+
+/**
+ * @brief Writes the buffered data if the flush interval has elapsed.
+ * This function should be called periodically from the thread that produces the data.
+ */
+void LogWriter::Update()
+{
+	m_impl->Update();
+}
+
+/**
+ * @brief Waits until all queued and buffered data are written.
+ */
+void LogWriter::Flush()
+{
+	m_impl->Flush();
+}
@@ -0,0 +1,40 @@
+/**
+ * @file
+ * @brief Log file writer.
+ */
+
+#pragma once
+
+#include <stddef.h>
+
+class LogWriter
+{
+	class Impl;
+	Impl *m_impl;  // std::unique_ptr is C++11
+
+	// disable implicit copy constructor and copy assignment operator
+	LogWriter( const LogWriter & );
+	LogWriter & operator=( const LogWriter & );
+
+public:
+	static const unsigned long NO_TIMEOUT = 0xFFFFFFFF;
+
+	LogWriter();
+	~LogWriter();
+
+	void SetFile( void *hFile );
+	void *GetFile() const;
+
+	void SetFlushInterval( unsigned int flushInterval );
+	void SetDropOldest( bool isDropOldest );
+
+	bool StartThread( size_t queueSize );
+	bool StopThread( unsigned long timeout = NO_TIMEOUT );
+	bool IsThreadRunning() const;
+
+	long GetDroppedCount() const;
+
+	void Write( const char *data, size_t length, bool isAppend = false, bool isFlush = false );
+	void Update();
+	void Flush();
+};
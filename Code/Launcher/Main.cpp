@@ -3,6 +3,8 @@
  * @brief Headless dedicated server launcher.
  */
 
+#include <ctype.h>
+
 // CryEngine headers
 #include "CryModuleDefs.h"
 #include "platform_impl.h"
@@ -14,6 +16,7 @@
 #include "EngineListener.h"
 #include "Validator.h"
 #include "TaskSystem.h"
+#include "WorkerPool.h"
 #include "Log.h"
 #include "MessageBoxHook.h"
 #include "ILauncher.h"
@@ -21,9 +24,17 @@
 #include "Patch.h"
 #include "CPU.h"
 #include "Util.h"
+#include "Clock.h"
+#include "MainLoop.h"
+#include "IdleMonitor.h"
+#include "ProfileDump.h"
+#include "Sampler.h"
+#include "HitchWatchdog.h"
 
 #include "config.h"
 
+#define LAUNCHER_MAX_WORKER_COUNT 16
+
 #ifdef BUILD_64BIT
 #define LAUNCHER_BUILD_VERSION C1HEADLESS_VERSION_STRING " 64-bit"
 #else
@@ -36,8 +47,10 @@ class GlobalLauncherEnv
 
 	unsigned char m_memLog[sizeof (Log)];
 	unsigned char m_memTaskSystem[sizeof (TaskSystem)];
+	unsigned char m_memWorkerPool[sizeof (WorkerPool)];
 	unsigned char m_memValidator[sizeof (Validator)];
 	unsigned char m_memEngineListener[sizeof (EngineListener)];
+	unsigned char m_memSampler[sizeof (Sampler)];
 
 public:
 	GlobalLauncherEnv()
@@ -50,12 +63,19 @@ public:
 
 	~GlobalLauncherEnv()
 	{
+		if ( gLauncher->pSampler )
+			gLauncher->pSampler->~Sampler();
+
 		if ( gLauncher->pEngineListener )
 			gLauncher->pEngineListener->~EngineListener();
 
 		if ( gLauncher->pValidator )
 			gLauncher->pValidator->~Validator();
 
+		// worker threads use the task system
+		if ( gLauncher->pWorkerPool )
+			gLauncher->pWorkerPool->~WorkerPool();
+
 		if ( gLauncher->pTaskSystem )
 			gLauncher->pTaskSystem->~TaskSystem();
 
@@ -75,6 +95,11 @@ public:
 		gLauncher->pTaskSystem = new (m_memTaskSystem) TaskSystem();
 	}
 
+	void InitWorkerPool()
+	{
+		gLauncher->pWorkerPool = new (m_memWorkerPool) WorkerPool();
+	}
+
 	void InitValidator()
 	{
 		gLauncher->pValidator = new (m_memValidator) Validator();
@@ -84,6 +109,11 @@ public:
 	{
 		gLauncher->pEngineListener = new (m_memEngineListener) EngineListener();
 	}
+
+	void InitSampler()
+	{
+		gLauncher->pSampler = new (m_memSampler) Sampler();
+	}
 };
 
 class DLLHandleGuard
@@ -195,6 +225,76 @@ public:
 	{
 		gLauncher->pLog->LogToStdErrV( format, args, prefix );
 	}
+
+	void DispatchTaskWithPriority( ILauncherTask *pTask, ELauncherTaskPriority priority ) override
+	{
+		gLauncher->pTaskSystem->AddTask( pTask, priority );
+	}
+
+	bool DispatchJob( ILauncherJob *pJob ) override
+	{
+		return gLauncher->pWorkerPool->AddJob( pJob );
+	}
+
+	int GetWorkerCount() override
+	{
+		return gLauncher->pWorkerPool->GetThreadCount();
+	}
+
+	unsigned int DispatchDelayedTask( ILauncherTask *pTask, unsigned int delay, unsigned int interval ) override
+	{
+		return gLauncher->pTaskSystem->AddTimer( pTask, delay, interval );
+	}
+
+	bool CancelDelayedTask( unsigned int handle ) override
+	{
+		return gLauncher->pTaskSystem->CancelTimer( handle );
+	}
+
+	bool AddFrameListener( ILauncherFrameListener *pListener ) override
+	{
+		return IsMainThread() && gLauncher->pEngineListener->AddFrameListener( pListener );
+	}
+
+	bool RemoveFrameListener( ILauncherFrameListener *pListener ) override
+	{
+		return IsMainThread() && gLauncher->pEngineListener->RemoveFrameListener( pListener );
+	}
+
+	double GetFrameTimePercentile( double percentile ) override
+	{
+		return gLauncher->pEngineListener->GetFrameStats().GetPercentile( percentile );
+	}
+
+	unsigned int GetFrameCountAbove( double frameTime ) override
+	{
+		const FrameStats & frameStats = gLauncher->pEngineListener->GetFrameStats();
+
+		return (frameTime > 0) ? frameStats.GetCountAbove( frameTime ) : frameStats.GetCount();
+	}
+
+	size_t CopyLogLines( unsigned long long seq, char *buffer, size_t bufferSize, unsigned long long *pFirstSeq,
+	                     unsigned long long *pNextSeq ) override
+	{
+		EngineLog *pEngineLog = gLauncher->pLog->GetEngineLog();
+
+		if ( ! pEngineLog || ! buffer )
+		{
+			if ( pFirstSeq )
+			{
+				*pFirstSeq = 0;
+			}
+
+			if ( pNextSeq )
+			{
+				*pNextSeq = seq;
+			}
+
+			return 0;
+		}
+
+		return pEngineLog->CopyRecentLines( seq, buffer, bufferSize, pFirstSeq, pNextSeq );
+	}
 };
 
 LauncherAPI *LauncherAPI::s_pInstance = NULL;
@@ -228,7 +328,106 @@ static void LogError( const char *format, ... )
 	va_end( args );
 }
 
-static int RunServer( HMODULE libCryGame )
+/**
+ * @brief Removes all occurrences of an argument and its value from a command line.
+ * The argument is case-insensitive and the value can be quoted like in CmdLine::GetArgValue.
+ * @param arg Lowercase argument name.
+ */
+static void RemoveArgWithValue( std::string & cmdLine, const char *arg )
+{
+	const size_t argLength = strlen( arg );
+
+	std::string lowerCmdLine = cmdLine;
+	for ( size_t i = 0; i < lowerCmdLine.length(); i++ )
+	{
+		lowerCmdLine[i] = tolower( lowerCmdLine[i] );
+	}
+
+	size_t pos = 0;
+
+	while ( (pos = lowerCmdLine.find( arg, pos )) != std::string::npos )
+	{
+		const size_t argEnd = pos + argLength;
+
+		// the argument must be a whole word
+		if ( pos == 0 || ! isspace( cmdLine[pos-1] ) || (argEnd < cmdLine.length() && ! isspace( cmdLine[argEnd] )) )
+		{
+			pos = argEnd;
+			continue;
+		}
+
+		size_t end = argEnd;
+
+		while ( end < cmdLine.length() && isspace( cmdLine[end] ) )
+		{
+			end++;
+		}
+
+		if ( end < cmdLine.length() && (cmdLine[end] == '\"' || cmdLine[end] == '\'') )
+		{
+			const size_t quoteEnd = cmdLine.find( cmdLine[end], end + 1 );
+
+			end = (quoteEnd != std::string::npos) ? quoteEnd + 1 : cmdLine.length();
+		}
+		else
+		{
+			while ( end < cmdLine.length() && ! isspace( cmdLine[end] ) )
+			{
+				end++;
+			}
+		}
+
+		// including the preceding space
+		cmdLine.erase( pos - 1, end - pos + 1 );
+		lowerCmdLine.erase( pos - 1, end - pos + 1 );
+		pos--;
+	}
+}
+
+/**
+ * @brief Starts a new server process with the same command line.
+ * Must be called only after the log is closed, so the new process can open the log files and create their backups.
+ * The launcher log is not available anymore, so errors are written directly to stderr.
+ * @param levelName Level requested by the engine. It replaces the level from the original command line. If it's
+ * empty, the original command line is used as it is.
+ */
+static void RestartServer( const char *levelName )
+{
+	std::string cmdLine = GetCommandLineA();
+
+	if ( levelName && *levelName )
+	{
+		RemoveArgWithValue( cmdLine, "+map" );
+
+		cmdLine += " +map ";
+		cmdLine += levelName;
+	}
+
+	STARTUPINFOA startupInfo;
+	memset( &startupInfo, 0, sizeof startupInfo );
+	startupInfo.cb = sizeof startupInfo;
+
+	PROCESS_INFORMATION processInfo;
+
+	// standard handles are inherited, so the output goes to the same place
+	if ( CreateProcessA( NULL, &cmdLine[0], NULL, NULL, TRUE, 0, NULL, NULL, &startupInfo, &processInfo ) )
+	{
+		CloseHandle( processInfo.hThread );
+		CloseHandle( processInfo.hProcess );
+	}
+	else
+	{
+		fprintf( stderr, "Error: Unable to restart the server: error code %lu\n", GetLastError() );
+		fflush( stderr );
+	}
+}
+
+/**
+ * @param isRestart Set to true if the engine requested restart of the server.
+ * @param restartLevel Set to the level of the new server process if the engine requested restart.
+ * @return Zero if no error occurred, otherwise -1.
+ */
+static int RunServer( HMODULE libCryGame, bool & isRestart, std::string & restartLevel )
 {
 	IGameStartup::TEntryFunction fCreateGameStartup;
 
@@ -274,6 +473,7 @@ static int RunServer( HMODULE libCryGame )
 	if ( gameRef == NULL )
 	{
 		LogError( "Engine initialization failed!" );
+		gLauncher->pWorkerPool->Stop();
 		pGameStartup->Shutdown();
 		return -1;
 	}
@@ -281,17 +481,120 @@ static int RunServer( HMODULE libCryGame )
 	// init CryEngine global environment for the launcher
 	ModuleInitISystem( params.pSystem );
 
+	// post-update notifications of frame listeners
+	IGameFramework *pGameFramework = (gEnv->pGame) ? gEnv->pGame->GetIGameFramework() : NULL;
+	gLauncher->pEngineListener->RegisterGameFramework( pGameFramework );
+
+	IdleMonitor idleMonitor;
+	idleMonitor.Init( pGameFramework );
+	gLauncher->pEngineListener->AddFrameListener( &idleMonitor );
+
+	ProfileDump profileDump;
+	if ( profileDump.Init() )
+	{
+		gLauncher->pEngineListener->AddFrameListener( &profileDump );
+	}
+
+	HitchWatchdog hitchWatchdog;
+	if ( hitchWatchdog.Start( pGameFramework ) )
+	{
+		gLauncher->pHitchWatchdog = &hitchWatchdog;
+	}
+	else
+	{
+		LogError( "Unable to start hitch watchdog: error code %lu", GetLastError() );
+	}
+
 	LogInfo( "Server started" );
 
 	// enter update loop
-	int status = pGameStartup->Run( NULL );
+	int status = 0;
+
+	if ( CmdLine::HasArg( "-launcherloop" ) )
+	{
+		MainLoop mainLoop;
+
+		gLauncher->pMainLoop = &mainLoop;
+		status = mainLoop.Run( pGameStartup );
+		gLauncher->pMainLoop = NULL;
+	}
+	else
+	{
+		status = pGameStartup->Run( NULL );
+	}
+
+	char *levelName = NULL;
+	if ( pGameStartup->GetRestartLevel( &levelName ) )
+	{
+		isRestart = true;
+		restartLevel = (levelName) ? levelName : "";
+	}
+
 	LogInfo( "Engine exit code: %d", status );
 
+	// the engine shutdown is not a hitch
+	gLauncher->pHitchWatchdog = NULL;
+	hitchWatchdog.Stop();
+
+	// workers may still use the engine
+	gLauncher->pWorkerPool->Stop();
+
+	// symbols are resolved while the engine modules are still loaded
+	if ( gLauncher->pSampler->IsRunning() )
+	{
+		if ( gLauncher->pSampler->Stop() )
+		{
+			LogInfo( "Sampling profiler output written to %s", gLauncher->pSampler->GetFileName() );
+		}
+		else
+		{
+			LogError( "Unable to write sampling profiler output to %s", gLauncher->pSampler->GetFileName() );
+		}
+	}
+
+	gLauncher->pEngineListener->RemoveFrameListener( &profileDump );
+	profileDump.Shutdown();
+
+	gLauncher->pEngineListener->RemoveFrameListener( &idleMonitor );
+	idleMonitor.Shutdown();
+
+	gLauncher->pEngineListener->UnregisterGameFramework();
+
 	pGameStartup->Shutdown();
 
+	if ( isRestart )
+	{
+		LogInfo( "Server restart requested: level = %s", restartLevel.c_str() );
+	}
+
 	return (status != 0) ? -1 : 0;
 }
 
+static void StartWorkerPool()
+{
+	// main thread has its own core
+	const int defaultCount = CPU::GetCoreCount() - 1;
+
+	int count = CmdLine::GetArgValueInt( "-workers", (defaultCount > 0) ? defaultCount : 1 );
+	if ( count > LAUNCHER_MAX_WORKER_COUNT )
+	{
+		count = LAUNCHER_MAX_WORKER_COUNT;
+	}
+
+	if ( count <= 0 )
+	{
+		LogInfo( "Worker threads disabled" );
+	}
+	else if ( gLauncher->pWorkerPool->Start( count ) )
+	{
+		LogInfo( "Worker threads: %d", count );
+	}
+	else
+	{
+		LogError( "Unable to start worker threads: error code %lu", GetLastError() );
+	}
+}
+
 static int InstallMemoryPatches( int version, void *libCryAction, void *libCryNetwork,
                                  void *libCrySystem, void *libCryRenderNULL )
 {
@@ -396,10 +699,8 @@ static bool GetRootFolder( std::string & rootFolder )
 	return true;
 }
 
-int main()
+static int RunLauncher( bool & isRestart, std::string & restartLevel )
 {
-	MessageBoxHook::Init();
-
 	GlobalLauncherEnv env;
 	LauncherAPI api;
 
@@ -499,8 +800,10 @@ int main()
 
 	// init the remaining global stuff
 	env.InitTaskSystem();
+	env.InitWorkerPool();
 	env.InitValidator();
 	env.InitEngineListerner();
+	env.InitSampler();
 
 	// init CryEngine log replacement
 	if ( ! gLauncher->pLog->InitEngineLog() )
@@ -514,9 +817,50 @@ int main()
 		LogInfo( "Log initialized: file = %s | verbosity = %d", pLog->GetFileName(), pLog->GetVerbosityLevel() );
 	}
 
+	StartWorkerPool();
+
+	if ( CmdLine::HasArg( "-profile" ) )
+	{
+		std::string profileFileName = CmdLine::GetArgValue( "-profile" );
+
+		// the file name is optional
+		if ( ! profileFileName.empty() && (profileFileName[0] == '-' || profileFileName[0] == '+') )
+		{
+			profileFileName.clear();
+		}
+
+		if ( gLauncher->pSampler->Start( profileFileName.c_str() ) )
+		{
+			LogInfo( "Sampling profiler started" );
+		}
+		else
+		{
+			LogError( "Unable to start sampling profiler: error code %lu", GetLastError() );
+		}
+	}
+
 	// launch the server
-	int status = RunServer( libCryGame );
+	int status = RunServer( libCryGame, isRestart, restartLevel );
 
 	return (status < 0) ? 1 : 0;
 }
 
+int main()
+{
+	MessageBoxHook::Init();
+	Clock::Init();
+
+	bool isRestart = false;
+	std::string restartLevel;
+
+	const int exitCode = RunLauncher( isRestart, restartLevel );
+
+	// the launcher environment is destroyed now, so all log files are closed
+	if ( isRestart )
+	{
+		RestartServer( restartLevel.c_str() );
+	}
+
+	return exitCode;
+}
+
@@ -0,0 +1,616 @@
+/**
+ * @file
+ * @brief Implementation of launcher main loop with precise frame pacing.
+ *
+ * The engine limits frame rate of dedicated server using Sleep, so the frame time depends on the system timer
+ * resolution and the scheduler. Here each frame has a deadline. Most of the remaining time is spent waiting for
+ * a high-resolution waitable timer and the last moment is spent spinning on the performance counter. Deadlines are
+ * derived from the previous deadline instead of the end of the previous frame, so errors don't accumulate.
+ *
+ * Optionally, the main loop waits for readiness of the game UDP socket instead of the timer. A frame then starts as
+ * soon as a packet arrives, but not earlier than allowed by the wake-up rate cap. The socket is owned by the engine and
+ * nobody tells us its handle, so it's found by the port number. Nothing is read from it.
+ */
+
+#define WIN32_LEAN_AND_MEAN
+#include <winsock2.h>  // must be included before windows.h
+#include <windows.h>
+#include <mmsystem.h>  // timeBeginPeriod
+#include <string.h>
+
+// CryEngine headers
+#include "ISystem.h"
+#include "IConsole.h"
+#include "IGameStartup.h"
+
+// Launcher headers
+#include "MainLoop.h"
+#include "LauncherEnv.h"
+#include "Clock.h"
+
+// time in seconds spent spinning before the deadline
+#define MAIN_LOOP_SPIN_TIME 0.002
+
+// the engine frame limiter is effectively disabled with this rate
+#define MAIN_LOOP_ENGINE_MAX_RATE 1000
+
+// time in seconds between attempts to find the game socket
+#define MAIN_LOOP_SOCKET_SEARCH_INTERVAL 5.0
+
+// socket handles are multiples of 4
+#define MAIN_LOOP_MAX_SOCKET_HANDLE 0x10000
+
+#define MAIN_LOOP_DEFAULT_PORT 64087
+
+// upper bounds of packet latency histogram buckets in microseconds, the last bucket is unbounded
+static const unsigned int PACKET_LATENCY_BOUNDS[] = { 50, 100, 250, 500, 1000, 2000, 5000, 10000, 20000, 50000 };
+
+#define PACKET_LATENCY_BUCKET_COUNT (sizeof PACKET_LATENCY_BOUNDS / sizeof PACKET_LATENCY_BOUNDS[0] + 1)
+
+/**
+ * @brief Finds UDP socket bound to the specified port in this process.
+ * @return The socket or INVALID_SOCKET if there is no such socket.
+ */
+static SOCKET FindUDPSocket( unsigned short port )
+{
+	for ( ULONG_PTR value = 4; value < MAIN_LOOP_MAX_SOCKET_HANDLE; value += 4 )
+	{
+		const SOCKET s = static_cast<SOCKET>( value );
+
+		// fails with WSAENOTSOCK for anything else than socket
+		int type = 0;
+		int typeLength = sizeof type;
+		if ( getsockopt( s, SOL_SOCKET, SO_TYPE, reinterpret_cast<char*>( &type ), &typeLength ) != 0 || type != SOCK_DGRAM )
+		{
+			continue;
+		}
+
+		sockaddr_in address;
+		int addressLength = sizeof address;
+		if ( getsockname( s, reinterpret_cast<sockaddr*>( &address ), &addressLength ) != 0 )
+		{
+			continue;
+		}
+
+		if ( address.sin_family == AF_INET && ntohs( address.sin_port ) == port )
+		{
+			return s;
+		}
+	}
+
+	return INVALID_SOCKET;
+}
+
+class MainLoop::Impl
+{
+	struct Stats
+	{
+		unsigned int frameCount;
+		unsigned int overrunCount;  //!< Number of frames that missed their deadline.
+		unsigned int resyncCount;   //!< Number of times the deadline was reset after a long frame.
+		double jitterSum;           //!< Seconds.
+		double maxJitter;           //!< Seconds.
+		double lastJitter;          //!< Seconds.
+
+		unsigned int wakeCount;       //!< Number of frames started early by a packet.
+		unsigned int lateCount;       //!< Number of packets noticed only after the frame.
+		unsigned int latencyCount;
+		unsigned int latencyBuckets[PACKET_LATENCY_BUCKET_COUNT];
+		double latencySum;            //!< Seconds.
+		double maxLatency;            //!< Seconds.
+	};
+
+	HANDLE m_hTimer;
+	bool m_isTimerPeriodSet;
+	bool m_isWinsockInit;
+
+	ICVar *m_pTickRateCVar;
+	ICVar *m_pWakeOnPacketCVar;
+	ICVar *m_pWakeMaxRateCVar;
+	ICVar *m_pPortCVar;
+	float m_rateOverride;
+
+	long long m_deadline;
+	long long m_frameStartTime;
+	long long m_packetTime;  //!< When a waiting packet was noticed or 0.
+
+	SOCKET m_gameSocket;
+	long long m_nextSocketSearchTime;
+
+	Stats m_stats;
+
+	// the only instance is used by the console command
+	static Impl *s_pInstance;
+
+	bool InitEngine();
+
+	void BeginFrame();
+	void WaitForNextFrame();
+	void WaitUntil( long long time );
+	void RecordJitter( double jitter );
+	void RecordLatency( double latency );
+
+	bool IsWakeOnPacket();
+	bool WaitForPacket( long long time );
+
+	static bool PumpMessages();
+
+	static void OnLoopStatsCmd( IConsoleCmdArgs *pArgs );
+
+public:
+	Impl()
+	: m_hTimer(NULL),
+	  m_isTimerPeriodSet(false),
+	  m_isWinsockInit(false),
+	  m_pTickRateCVar(NULL),
+	  m_pWakeOnPacketCVar(NULL),
+	  m_pWakeMaxRateCVar(NULL),
+	  m_pPortCVar(NULL),
+	  m_rateOverride(0),
+	  m_deadline(0),
+	  m_frameStartTime(0),
+	  m_packetTime(0),
+	  m_gameSocket(INVALID_SOCKET),
+	  m_nextSocketSearchTime(0)
+	{
+		ResetStats();
+
+		s_pInstance = this;
+	}
+
+	~Impl()
+	{
+		s_pInstance = NULL;
+
+		if ( m_isTimerPeriodSet )
+		{
+			timeEndPeriod( 1 );
+		}
+
+		if ( m_hTimer )
+		{
+			CloseHandle( m_hTimer );
+		}
+
+		if ( m_isWinsockInit )
+		{
+			WSACleanup();
+		}
+	}
+
+	void ResetStats()
+	{
+		memset( &m_stats, 0, sizeof m_stats );
+	}
+
+	float GetTargetRate() const
+	{
+		if ( m_rateOverride > 0 )
+		{
+			return m_rateOverride;
+		}
+
+		return (m_pTickRateCVar) ? m_pTickRateCVar->GetFVal() : 0;
+	}
+
+	void SetRateOverride( float rate )
+	{
+		m_rateOverride = rate;
+	}
+
+	int Run( IGameStartup *pGameStartup );
+};
+
+MainLoop::Impl *MainLoop::Impl::s_pInstance = NULL;
+
+bool MainLoop::Impl::InitEngine()
+{
+	IConsole *pConsole = gLauncher->pSystem->GetIConsole();
+
+	// take over the frame rate limit of the engine
+	float defaultRate = 30;
+	if ( ICVar *pEngineRateCVar = pConsole->GetCVar( "sv_DedicatedMaxRate" ) )
+	{
+		defaultRate = pEngineRateCVar->GetFVal();
+		pEngineRateCVar->Set( MAIN_LOOP_ENGINE_MAX_RATE );
+	}
+
+	m_pTickRateCVar = pConsole->RegisterFloat( "launcher_TickRate", defaultRate, VF_NOT_NET_SYNCED,
+	  "Target server frame rate of the launcher main loop.\n"
+	  "Replaces sv_DedicatedMaxRate when the launcher is started with -launcherloop.\n"
+	  "Usage: launcher_TickRate [rate]\n"
+	  "  0 = Unlimited. Default is the original value of sv_DedicatedMaxRate."
+	);
+
+	m_pWakeOnPacketCVar = pConsole->RegisterInt( "launcher_WakeOnPacket", 1, VF_NOT_NET_SYNCED,
+	  "Starts the next frame of the launcher main loop as soon as a packet arrives to the game port.\n"
+	  "Usage: launcher_WakeOnPacket [0/1]\n"
+	  "Default is 1 (enabled)."
+	);
+
+	m_pWakeMaxRateCVar = pConsole->RegisterFloat( "launcher_WakeMaxRate", 100, VF_NOT_NET_SYNCED,
+	  "Maximum server frame rate when frames are started early by incoming packets.\n"
+	  "Usage: launcher_WakeMaxRate [rate]\n"
+	  "  0 = Unlimited. Default is 100."
+	);
+
+	m_pPortCVar = pConsole->GetCVar( "sv_port" );
+
+	pConsole->AddCommand( "launcher_loopstats", OnLoopStatsCmd, 0,
+	  "Shows frame pacing statistics of the launcher main loop.\n"
+	  "Usage: launcher_loopstats [reset]"
+	);
+
+	return m_pTickRateCVar != NULL;
+}
+
+void MainLoop::Impl::RecordJitter( double jitter )
+{
+	m_stats.lastJitter = jitter;
+	m_stats.jitterSum += jitter;
+
+	if ( jitter > m_stats.maxJitter )
+	{
+		m_stats.maxJitter = jitter;
+	}
+}
+
+void MainLoop::Impl::RecordLatency( double latency )
+{
+	const double latencyMicroseconds = latency * 1000000;
+
+	size_t bucket = 0;
+	while ( bucket < PACKET_LATENCY_BUCKET_COUNT - 1 && latencyMicroseconds >= PACKET_LATENCY_BOUNDS[bucket] )
+	{
+		bucket++;
+	}
+
+	m_stats.latencyBuckets[bucket]++;
+	m_stats.latencyCount++;
+	m_stats.latencySum += latency;
+
+	if ( latency > m_stats.maxLatency )
+	{
+		m_stats.maxLatency = latency;
+	}
+}
+
+/**
+ * @brief Waits without spinning until the specified time.
+ * The waitable timer may return up to 1 ms later.
+ */
+void MainLoop::Impl::WaitUntil( long long time )
+{
+	const long long waitTime = time - Clock::GetTicks();
+	if ( waitTime <= 0 )
+	{
+		return;
+	}
+
+	// relative time in 100-nanosecond intervals
+	LARGE_INTEGER dueTime;
+	dueTime.QuadPart = -static_cast<LONGLONG>( Clock::TicksToSeconds( waitTime ) * 10000000 );
+
+	if ( m_hTimer && SetWaitableTimer( m_hTimer, &dueTime, 0, NULL, NULL, FALSE ) )
+	{
+		WaitForSingleObject( m_hTimer, INFINITE );
+	}
+	else
+	{
+		Sleep( static_cast<DWORD>( Clock::TicksToSeconds( waitTime ) * 1000 ) );
+	}
+}
+
+/**
+ * @return True if frames can be started by incoming packets, otherwise false.
+ */
+bool MainLoop::Impl::IsWakeOnPacket()
+{
+	if ( ! m_isWinsockInit || ! m_pWakeOnPacketCVar || m_pWakeOnPacketCVar->GetIVal() == 0 )
+	{
+		return false;
+	}
+
+	// keep the low-power mode of empty server
+	if ( m_rateOverride > 0 )
+	{
+		return false;
+	}
+
+	if ( m_gameSocket == INVALID_SOCKET )
+	{
+		// the server may be started later by a console command
+		const long long currentTime = Clock::GetTicks();
+		if ( currentTime < m_nextSocketSearchTime )
+		{
+			return false;
+		}
+
+		m_nextSocketSearchTime = currentTime + Clock::SecondsToTicks( MAIN_LOOP_SOCKET_SEARCH_INTERVAL );
+
+		const int port = (m_pPortCVar) ? m_pPortCVar->GetIVal() : MAIN_LOOP_DEFAULT_PORT;
+
+		m_gameSocket = FindUDPSocket( static_cast<unsigned short>( port ) );
+		if ( m_gameSocket == INVALID_SOCKET )
+		{
+			return false;
+		}
+
+		CryLogAlways( "$3[Launcher] Main loop wakes up on packets to port %d", port );
+	}
+
+	return true;
+}
+
+/**
+ * @brief Waits until a packet arrives to the game socket or until the specified time.
+ * @return True if a packet is waiting, otherwise false.
+ */
+bool MainLoop::Impl::WaitForPacket( long long time )
+{
+	long long waitTime = time - Clock::GetTicks();
+	if ( waitTime < 0 )
+	{
+		waitTime = 0;
+	}
+
+	const long long waitMicroseconds = static_cast<long long>( Clock::TicksToSeconds( waitTime ) * 1000000 );
+
+	timeval timeout;
+	timeout.tv_sec = static_cast<long>( waitMicroseconds / 1000000 );
+	timeout.tv_usec = static_cast<long>( waitMicroseconds % 1000000 );
+
+	fd_set readSet;
+	FD_ZERO( &readSet );
+	FD_SET( m_gameSocket, &readSet );
+
+	const int result = select( 0, &readSet, NULL, NULL, &timeout );
+	if ( result == SOCKET_ERROR )
+	{
+		// the socket was closed, so find it again later
+		m_gameSocket = INVALID_SOCKET;
+
+		// don't return too early
+		WaitUntil( time );
+
+		return false;
+	}
+
+	return result > 0;
+}
+
+void MainLoop::Impl::BeginFrame()
+{
+	m_frameStartTime = Clock::GetTicks();
+
+	if ( m_packetTime )
+	{
+		RecordLatency( Clock::TicksToSeconds( m_frameStartTime - m_packetTime ) );
+		m_packetTime = 0;
+	}
+}
+
+void MainLoop::Impl::WaitForNextFrame()
+{
+	const float rate = GetTargetRate();
+	if ( rate <= 0 )
+	{
+		// unlimited
+		m_deadline = 0;
+		return;
+	}
+
+	const long long period = Clock::SecondsToTicks( 1.0 / rate );
+	long long currentTime = Clock::GetTicks();
+
+	if ( m_deadline == 0 )
+	{
+		m_deadline = m_frameStartTime + period;
+	}
+
+	if ( currentTime >= m_deadline )
+	{
+		m_stats.overrunCount++;
+
+		// don't try to catch up after a long frame
+		if ( currentTime - m_deadline > period )
+		{
+			m_deadline = currentTime;
+			m_stats.resyncCount++;
+		}
+
+		m_deadline += period;
+
+		return;
+	}
+
+	const long long spinTime = Clock::SecondsToTicks( MAIN_LOOP_SPIN_TIME );
+
+	if ( IsWakeOnPacket() )
+	{
+		// packet that arrived during the frame
+		if ( ! m_packetTime && WaitForPacket( currentTime ) )
+		{
+			m_packetTime = currentTime;
+			m_stats.lateCount++;
+		}
+
+		const float maxRate = m_pWakeMaxRateCVar->GetFVal();
+		const long long wakeTime = (maxRate > 0) ? m_frameStartTime + Clock::SecondsToTicks( 1.0 / maxRate ) : 0;
+
+		// the deadline stays the same, so early frames don't shift the regular ones
+		if ( wakeTime < m_deadline - spinTime )
+		{
+			WaitUntil( wakeTime );
+
+			if ( m_packetTime )
+			{
+				m_stats.wakeCount++;
+				return;
+			}
+
+			if ( m_gameSocket != INVALID_SOCKET && WaitForPacket( m_deadline - spinTime ) )
+			{
+				m_packetTime = Clock::GetTicks();
+				m_stats.wakeCount++;
+				return;
+			}
+		}
+	}
+
+	WaitUntil( m_deadline - spinTime );
+
+	do
+	{
+		YieldProcessor();
+		currentTime = Clock::GetTicks();
+	}
+	while ( currentTime < m_deadline );
+
+	RecordJitter( Clock::TicksToSeconds( currentTime - m_deadline ) );
+
+	m_deadline += period;
+}
+
+/**
+ * @return False if the application should quit, otherwise true.
+ */
+bool MainLoop::Impl::PumpMessages()  // static function
+{
+	MSG msg;
+	while ( PeekMessageA( &msg, NULL, 0, 0, PM_REMOVE ) )
+	{
+		if ( msg.message == WM_QUIT )
+		{
+			return false;
+		}
+
+		TranslateMessage( &msg );
+		DispatchMessageA( &msg );
+	}
+
+	return true;
+}
+
+int MainLoop::Impl::Run( IGameStartup *pGameStartup )
+{
+	if ( ! InitEngine() )
+	{
+		return -1;
+	}
+
+	m_hTimer = CreateWaitableTimerA( NULL, TRUE, NULL );
+
+	// 1 ms system timer resolution makes the waitable timer precise enough
+	m_isTimerPeriodSet = (timeBeginPeriod( 1 ) == TIMERR_NOERROR);
+
+	WSADATA wsaData;
+	m_isWinsockInit = (WSAStartup( MAKEWORD( 2, 2 ), &wsaData ) == 0);
+
+	gLauncher->pSystem->GetIConsole()->ExecuteString( "exec autoexec.cfg" );
+
+	while ( PumpMessages() )
+	{
+		BeginFrame();
+
+		if ( ! pGameStartup->Update( true, 0 ) )
+		{
+			break;
+		}
+
+		m_stats.frameCount++;
+
+		WaitForNextFrame();
+	}
+
+	return 0;
+}
+
+void MainLoop::Impl::OnLoopStatsCmd( IConsoleCmdArgs *pArgs )  // static function
+{
+	Impl *self = s_pInstance;
+	if ( ! self )
+	{
+		return;
+	}
+
+	if ( pArgs->GetArgCount() > 1 && strcmp( pArgs->GetArg( 1 ), "reset" ) == 0 )
+	{
+		self->ResetStats();
+		CryLogAlways( "Launcher main loop statistics reset" );
+		return;
+	}
+
+	const Stats & stats = self->m_stats;
+	const unsigned int pacedCount = stats.frameCount - stats.overrunCount - stats.wakeCount;
+
+	CryLogAlways( "$3Launcher main loop: target rate = %.1f | frames = %u", self->GetTargetRate(), stats.frameCount );
+	CryLogAlways( "Jitter | last = %.3f ms | average = %.3f ms | max = %.3f ms", stats.lastJitter * 1000,
+	  (pacedCount > 0) ? stats.jitterSum / pacedCount * 1000 : 0, stats.maxJitter * 1000 );
+	CryLogAlways( "Overruns | missed deadlines = %u | resyncs = %u | timer resolution = %s",
+	  stats.overrunCount, stats.resyncCount, (self->m_isTimerPeriodSet) ? "1 ms" : "default" );
+
+	CryLogAlways( "Packets | socket = %s | early frames = %u | noticed after frame = %u",
+	  (self->m_gameSocket != INVALID_SOCKET) ? "found" : "not found", stats.wakeCount, stats.lateCount );
+
+	CryLogAlways( "Packet latency | samples = %u | average = %.3f ms | max = %.3f ms", stats.latencyCount,
+	  (stats.latencyCount > 0) ? stats.latencySum / stats.latencyCount * 1000 : 0, stats.maxLatency * 1000 );
+
+	for ( size_t i = 0; i < PACKET_LATENCY_BUCKET_COUNT; i++ )
+	{
+		if ( i < PACKET_LATENCY_BUCKET_COUNT - 1 )
+		{
+			CryLogAlways( "  < %5u us | %u", PACKET_LATENCY_BOUNDS[i], stats.latencyBuckets[i] );
+		}
+		else
+		{
+			CryLogAlways( " >= %5u us | %u", PACKET_LATENCY_BOUNDS[i-1], stats.latencyBuckets[i] );
+		}
+	}
+}
+
+/**
+ * @brief Constructor.
+ */
+MainLoop::MainLoop()
+: m_impl(new Impl())
+{
+}
+
+/**
+ * @brief Destructor.
+ */
+MainLoop::~MainLoop()
+{
+	delete m_impl;
+}
+
+/**
+ * @brief Runs the game until it quits.
+ * Replacement of IGameStartup::Run that drives IGameStartup::Update itself.
+ * This function MUST be called only from main thread after the engine is initialized.
+ * @param pGameStartup The game startup interface.
+ * @return 0 when the game terminated normally, non-zero otherwise.
+ */
+int MainLoop::Run( IGameStartup *pGameStartup )
+{
+	return m_impl->Run( pGameStartup );
+}
+
+/**
+ * @brief Returns target frame rate.
+ * @return Frames per second or 0 if unlimited.
+ */
+float MainLoop::GetTargetRate() const
+{
+	return m_impl->GetTargetRate();
+}
+
+/**
+ * @brief Temporarily replaces the target frame rate set by launcher_TickRate cvar.
+ * @param rate Frames per second or 0 to use the cvar again.
+ */
+void MainLoop::SetRateOverride( float rate )
+{
+	m_impl->SetRateOverride( rate );
+}
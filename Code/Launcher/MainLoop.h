@@ -0,0 +1,28 @@
+/**
+ * @file
+ * @brief Launcher main loop with precise frame pacing.
+ */
+
+#pragma once
+
+struct IGameStartup;
+
+class MainLoop
+{
+	class Impl;
+	Impl *m_impl;  // std::unique_ptr is C++11
+
+	// disable implicit copy constructor and copy assignment operator
+	MainLoop( const MainLoop & );
+	MainLoop & operator=( const MainLoop & );
+
+public:
+	MainLoop();
+	~MainLoop();
+
+	int Run( IGameStartup *pGameStartup );
+
+	float GetTargetRate() const;
+
+	void SetRateOverride( float rate );
+};
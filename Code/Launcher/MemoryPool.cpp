@@ -0,0 +1,143 @@
+/**
+ * @file
+ * @brief Implementation of fixed-capacity pool of memory blocks.
+ */
+
+#include <new>
+
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+
+// Launcher headers
+#include "MemoryPool.h"
+
+// the list header is stored at the beginning of the slab because of its alignment requirements
+#define POOL_HEADER_SIZE ((sizeof (SLIST_HEADER) + MEMORY_ALLOCATION_ALIGNMENT - 1) & ~(MEMORY_ALLOCATION_ALIGNMENT - 1))
+
+static PSLIST_HEADER GetFreeList( unsigned char *slab )
+{
+	return reinterpret_cast<PSLIST_HEADER>( slab );
+}
+
+/**
+ * @brief Constructor.
+ * No memory is allocated until Init is called.
+ */
+MemoryPool::MemoryPool()
+: m_slab(NULL),
+  m_slabSize(0),
+  m_blockSize(0),
+  m_blockCount(0),
+  m_usedCount(0),
+  m_overflowCount(0)
+{
+}
+
+/**
+ * @brief Destructor.
+ * All blocks from the pool must be released before the pool is destroyed.
+ */
+MemoryPool::~MemoryPool()
+{
+	if ( m_slab )
+	{
+		VirtualFree( m_slab, 0, MEM_RELEASE );
+	}
+}
+
+/**
+ * @brief Allocates all blocks of the pool.
+ * The blocks are allocated directly using VirtualAlloc, so the pool can be initialized even before the engine
+ * memory manager is ready.
+ * @param blockSize Size of one block in bytes.
+ * @param blockCount Number of blocks.
+ * @return True if no error occurred, otherwise false.
+ */
+bool MemoryPool::Init( size_t blockSize, size_t blockCount )
+{
+	if ( m_slab || blockCount == 0 )
+	{
+		return false;
+	}
+
+	// each free block contains a list entry, so it must be properly aligned
+	blockSize = (blockSize + MEMORY_ALLOCATION_ALIGNMENT - 1) & ~(MEMORY_ALLOCATION_ALIGNMENT - 1);
+
+	if ( blockSize < sizeof (SLIST_ENTRY) )
+	{
+		blockSize = sizeof (SLIST_ENTRY);
+	}
+
+	const size_t slabSize = POOL_HEADER_SIZE + (blockSize * blockCount);
+
+	unsigned char *slab = static_cast<unsigned char*>( VirtualAlloc( NULL, slabSize, MEM_COMMIT | MEM_RESERVE,
+	                                                                 PAGE_READWRITE ) );
+	if ( ! slab )
+	{
+		return false;
+	}
+
+	PSLIST_HEADER pFreeList = GetFreeList( slab );
+	InitializeSListHead( pFreeList );
+
+	// push blocks in reverse order, so the first allocation gets the first block
+	for ( size_t i = blockCount; i > 0; i-- )
+	{
+		unsigned char *block = slab + POOL_HEADER_SIZE + (blockSize * (i-1));
+		InterlockedPushEntrySList( pFreeList, reinterpret_cast<PSLIST_ENTRY>( block ) );
+	}
+
+	m_slab = slab;
+	m_slabSize = slabSize;
+	m_blockSize = blockSize;
+	m_blockCount = blockCount;
+
+	return true;
+}
+
+/**
+ * @brief Allocates one block.
+ * Heap is used if the pool is exhausted or if the requested size is larger than the block size.
+ * This function can be called from any thread.
+ * @param size Required size in bytes.
+ * @return The allocated memory. Never NULL.
+ */
+void *MemoryPool::Alloc( size_t size )
+{
+	if ( m_slab && size <= m_blockSize )
+	{
+		void *block = InterlockedPopEntrySList( GetFreeList( m_slab ) );
+		if ( block )
+		{
+			InterlockedIncrement( &m_usedCount );
+			return block;
+		}
+	}
+
+	InterlockedIncrement( &m_overflowCount );
+
+	return ::operator new( size );
+}
+
+/**
+ * @brief Releases block allocated using Alloc.
+ * This function can be called from any thread.
+ * @param p The block or NULL.
+ */
+void MemoryPool::Free( void *p )
+{
+	if ( ! p )
+	{
+		return;
+	}
+
+	if ( IsFromSlab( p ) )
+	{
+		InterlockedPushEntrySList( GetFreeList( m_slab ), static_cast<PSLIST_ENTRY>( p ) );
+		InterlockedDecrement( &m_usedCount );
+	}
+	else
+	{
+		::operator delete( p );
+	}
+}
@@ -0,0 +1,57 @@
+/**
+ * @file
+ * @brief Fixed-capacity pool of memory blocks.
+ */
+
+#pragma once
+
+#include <stddef.h>
+
+class MemoryPool
+{
+	unsigned char *m_slab;
+	size_t m_slabSize;
+	size_t m_blockSize;
+	size_t m_blockCount;
+
+	volatile long m_usedCount;
+	volatile long m_overflowCount;
+
+	// disable implicit copy constructor and copy assignment operator
+	MemoryPool( const MemoryPool & );
+	MemoryPool & operator=( const MemoryPool & );
+
+	bool IsFromSlab( const void *p ) const
+	{
+		return p >= m_slab && p < m_slab + m_slabSize;
+	}
+
+public:
+	MemoryPool();
+	~MemoryPool();
+
+	bool Init( size_t blockSize, size_t blockCount );
+
+	void *Alloc( size_t size );
+	void Free( void *p );
+
+	size_t GetBlockSize() const
+	{
+		return m_blockSize;
+	}
+
+	size_t GetBlockCount() const
+	{
+		return m_blockCount;
+	}
+
+	long GetUsedCount() const
+	{
+		return m_usedCount;
+	}
+
+	long GetOverflowCount() const
+	{
+		return m_overflowCount;
+	}
+};
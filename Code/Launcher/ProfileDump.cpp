@@ -0,0 +1,416 @@
+/**
+ * @file
+ * @brief Implementation of headless output of the engine frame profiler.
+ *
+ * The frame profiler is enabled for collection only, so nothing is drawn. Self time of each profiler is taken from
+ * its total over the whole profiling period, so sections are walked only once per interval instead of every frame.
+ * Peaks are reported by the profiler during its end of frame processing, so they are only remembered there and the
+ * breakdown of the frame is logged at the beginning of the next frame from the last samples of each profiler.
+ */
+
+#include <string.h>
+#include <algorithm>
+#include <string>
+
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+
+// CryEngine headers
+#include "ISystem.h"
+#include "IConsole.h"
+
+// Launcher headers
+#include "ProfileDump.h"
+#include "LauncherEnv.h"
+#include "CmdLine.h"
+#include "Clock.h"
+#include "StringBuffer.h"
+
+// minimum time in seconds between two logged peak frames
+#define PROFILE_DUMP_PEAK_LOG_INTERVAL 1.0f
+
+// sections with lower self time in milliseconds are omitted from the peak frame breakdown
+#define PROFILE_DUMP_PEAK_MIN_SECTION_TIME 0.01f
+
+#define PROFILE_DUMP_MAX_PEAKS 16
+
+typedef StringBuffer<16384> ProfileDumpBuffer;
+
+static const char *GetSubsystemName( EProfiledSubsystem subsystem )
+{
+	switch ( subsystem )
+	{
+		case PROFILE_ANY:             return "Any";
+		case PROFILE_RENDERER:        return "Renderer";
+		case PROFILE_3DENGINE:        return "3DEngine";
+		case PROFILE_PARTICLE:        return "Particle";
+		case PROFILE_AI:              return "AI";
+		case PROFILE_ANIMATION:       return "Animation";
+		case PROFILE_MOVIE:           return "Movie";
+		case PROFILE_ENTITY:          return "Entity";
+		case PROFILE_FONT:            return "Font";
+		case PROFILE_NETWORK:         return "Network";
+		case PROFILE_PHYSICS:         return "Physics";
+		case PROFILE_SCRIPT:          return "Script";
+		case PROFILE_SOUND:           return "Sound";
+		case PROFILE_MUSIC:           return "Music";
+		case PROFILE_EDITOR:          return "Editor";
+		case PROFILE_SYSTEM:          return "System";
+		case PROFILE_GAME:            return "Game";
+		case PROFILE_INPUT:           return "Input";
+		case PROFILE_SYNC:            return "Sync";
+		case PROFILE_NETWORK_TRAFFIC: return "NetworkTraffic";
+		case PROFILE_LAST_SUBSYSTEM:  break;
+	}
+
+	return "Unknown";
+}
+
+static void AddJsonString( ProfileDumpBuffer & buffer, const char *text )
+{
+	buffer.append( '\"' );
+
+	for ( ; *text; text++ )
+	{
+		const char ch = *text;
+
+		if ( ch == '\"' || ch == '\\' )
+		{
+			buffer.append( '\\' );
+			buffer.append( ch );
+		}
+		else if ( static_cast<unsigned char>( ch ) >= ' ' )
+		{
+			buffer.append( ch );
+		}
+	}
+
+	buffer.append( '\"' );
+}
+
+struct ProfileSection
+{
+	CFrameProfiler *pProfiler;
+	double selfTime;  //!< Milliseconds per frame.
+
+	/**
+	 * @brief Sorts sections by subsystem and then from the most expensive.
+	 */
+	bool operator<( const ProfileSection & other ) const
+	{
+		if ( pProfiler->m_subsystem != other.pProfiler->m_subsystem )
+		{
+			return pProfiler->m_subsystem < other.pProfiler->m_subsystem;
+		}
+
+		return selfTime > other.selfTime;
+	}
+};
+
+static bool CompareSectionsByLastTime( CFrameProfiler *pA, CFrameProfiler *pB )
+{
+	return pA->m_selfTimeHistory.GetLast() > pB->m_selfTimeHistory.GetLast();
+}
+
+ProfileDump::ProfileDump()
+: m_pProfileSystem(NULL),
+  m_hFile(NULL),
+  m_pIntervalCVar(NULL),
+  m_pTopCountCVar(NULL),
+  m_lastSelfTimes(),
+  m_peaks(),
+  m_elapsedTime(0),
+  m_lastPeakLogTime(0),
+  m_frameCount(0)
+{
+}
+
+ProfileDump::~ProfileDump()
+{
+	Shutdown();
+}
+
+bool ProfileDump::OpenFile( const char *fileName )
+{
+	std::string filePath = gLauncher->rootFolder;
+	filePath += '\\';
+	filePath += fileName;
+
+	HANDLE hFile = CreateFileA( filePath.c_str(), GENERIC_WRITE, FILE_SHARE_READ,
+	                            NULL, OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL );
+	if ( hFile == INVALID_HANDLE_VALUE )
+	{
+		CryLogAlways( "$4[Error] Unable to open profile dump file '%s': error code %lu", filePath.c_str(), GetLastError() );
+		return false;
+	}
+
+	SetFilePointer( hFile, 0, NULL, FILE_END );
+
+	m_hFile = hFile;
+
+	return true;
+}
+
+/**
+ * @brief Writes the most expensive sections of each subsystem since the last write as one JSON line.
+ */
+void ProfileDump::WriteToFile()
+{
+	const int profilerCount = m_pProfileSystem->GetProfilerCount();
+	const int topCount = (m_pTopCountCVar) ? m_pTopCountCVar->GetIVal() : 0;
+
+	// profilers are never removed, new ones are appended
+	m_lastSelfTimes.resize( profilerCount, 0 );
+
+	std::vector<ProfileSection> sections;
+	sections.reserve( profilerCount );
+
+	for ( int i = 0; i < profilerCount; i++ )
+	{
+		CFrameProfiler *pProfiler = m_pProfileSystem->GetProfiler( i );
+		if ( ! pProfiler )
+		{
+			continue;
+		}
+
+		const int64 selfTime = pProfiler->m_sumSelfTime - m_lastSelfTimes[i];
+		m_lastSelfTimes[i] = pProfiler->m_sumSelfTime;
+
+		// network traffic profilers count bytes instead of time
+		if ( selfTime <= 0 || pProfiler->m_subsystem == PROFILE_NETWORK_TRAFFIC )
+		{
+			continue;
+		}
+
+		ProfileSection section;
+		section.pProfiler = pProfiler;
+		section.selfTime = m_pProfileSystem->TicksToSeconds( selfTime ) * 1000 / m_frameCount;
+
+		sections.push_back( section );
+	}
+
+	std::sort( sections.begin(), sections.end() );
+
+	ProfileDumpBuffer buffer;
+
+	buffer.append( "{\"uptime\":" );
+	buffer.append_fixed<3, 0>( Clock::GetUptime( Clock::GetTicks() ) );
+	buffer.append( ",\"interval\":" );
+	buffer.append_fixed<3, 0>( m_elapsedTime );
+	buffer.append( ",\"frames\":" );
+	buffer.append_uint( m_frameCount );
+	buffer.append( ",\"subsystems\":{" );
+
+	size_t i = 0;
+	while ( i < sections.size() )
+	{
+		const EProfiledSubsystem subsystem = sections[i].pProfiler->m_subsystem;
+
+		size_t end = i;
+		double totalTime = 0;
+		while ( end < sections.size() && sections[end].pProfiler->m_subsystem == subsystem )
+		{
+			totalTime += sections[end].selfTime;
+			end++;
+		}
+
+		if ( i > 0 )
+		{
+			buffer.append( ',' );
+		}
+
+		buffer.append( '\"' );
+		buffer.append( GetSubsystemName( subsystem ) );
+		buffer.append( "\":{\"self\":" );
+		buffer.append_fixed<3, 0>( totalTime );
+		buffer.append( ",\"top\":[" );
+
+		for ( size_t j = i; j < end && (topCount <= 0 || j - i < static_cast<size_t>( topCount )); j++ )
+		{
+			CFrameProfiler *pProfiler = sections[j].pProfiler;
+
+			if ( j > i )
+			{
+				buffer.append( ',' );
+			}
+
+			buffer.append( "{\"name\":" );
+			AddJsonString( buffer, pProfiler->m_name );
+			buffer.append( ",\"self\":" );
+			buffer.append_fixed<3, 0>( sections[j].selfTime );
+			buffer.append( ",\"calls\":" );
+			buffer.append_fixed<1, 0>( pProfiler->m_countHistory.GetAverage() );
+			buffer.append( '}' );
+		}
+
+		buffer.append( "]}" );
+
+		i = end;
+	}
+
+	buffer.append( "}}\n" );
+
+	DWORD bytesWritten;
+	WriteFile( m_hFile, buffer.get(), static_cast<DWORD>( buffer.getLength() ), &bytesWritten, NULL );
+}
+
+void ProfileDump::LogPeaks( unsigned int frameID )
+{
+	for ( size_t i = 0; i < m_peaks.size(); i++ )
+	{
+		CryLogAlways( "$6[Profiler] Peak in frame %u: %s = %.2f ms", frameID - 1, m_peaks[i].pProfiler->m_name,
+		  m_peaks[i].peakTime );
+	}
+
+	std::vector<CFrameProfiler*> profilers;
+
+	const int profilerCount = m_pProfileSystem->GetProfilerCount();
+
+	for ( int i = 0; i < profilerCount; i++ )
+	{
+		CFrameProfiler *pProfiler = m_pProfileSystem->GetProfiler( i );
+
+		if ( pProfiler && pProfiler->m_subsystem != PROFILE_NETWORK_TRAFFIC
+		  && pProfiler->m_selfTimeHistory.GetLast() >= PROFILE_DUMP_PEAK_MIN_SECTION_TIME )
+		{
+			profilers.push_back( pProfiler );
+		}
+	}
+
+	std::sort( profilers.begin(), profilers.end(), CompareSectionsByLastTime );
+
+	CryLogAlways( "$6[Profiler] Sections of frame %u:", frameID - 1 );
+
+	for ( size_t i = 0; i < profilers.size(); i++ )
+	{
+		CFrameProfiler *pProfiler = profilers[i];
+
+		CryLogAlways( "  %8.2f ms self | %8.2f ms total | %4d calls | %-10s | %s",
+		  pProfiler->m_selfTimeHistory.GetLast(),
+		  pProfiler->m_totalTimeHistory.GetLast(),
+		  pProfiler->m_countHistory.GetLast(),
+		  GetSubsystemName( pProfiler->m_subsystem ),
+		  pProfiler->m_name );
+	}
+}
+
+/**
+ * @brief Enables the frame profiler if the launcher was started with -profiledump command line parameter.
+ * @return True if the profiler is enabled, otherwise false.
+ */
+bool ProfileDump::Init()
+{
+	std::string fileName = CmdLine::GetArgValue( "-profiledump" );
+	if ( fileName.empty() )
+	{
+		return false;
+	}
+
+	IFrameProfileSystem *pProfileSystem = gLauncher->pSystem->GetIProfileSystem();
+	if ( ! pProfileSystem )
+	{
+		CryLogAlways( "$4[Error] Frame profiler is not available" );
+		return false;
+	}
+
+	if ( ! OpenFile( fileName.c_str() ) )
+	{
+		return false;
+	}
+
+	IConsole *pConsole = gLauncher->pSystem->GetIConsole();
+
+	m_pIntervalCVar = pConsole->RegisterFloat( "launcher_ProfileDumpInterval", 10, VF_NOT_NET_SYNCED,
+	  "Time in seconds between writes to the profile dump file enabled by -profiledump command line parameter.\n"
+	  "Usage: launcher_ProfileDumpInterval [seconds]\n"
+	  "Default is 10 seconds."
+	);
+
+	m_pTopCountCVar = pConsole->RegisterInt( "launcher_ProfileDumpTop", 5, VF_NOT_NET_SYNCED,
+	  "Number of the most expensive profiler sections of each subsystem written to the profile dump file.\n"
+	  "Usage: launcher_ProfileDumpTop [count]\n"
+	  "  0 = All sections. Default is 5."
+	);
+
+	// collect only, there is nothing to display on dedicated server
+	pProfileSystem->Enable( true, false );
+	pProfileSystem->AddPeaksListener( this );
+
+	m_pProfileSystem = pProfileSystem;
+	m_peaks.reserve( PROFILE_DUMP_MAX_PEAKS );
+
+	CryLogAlways( "$3[Launcher] Frame profiler enabled, writing to '%s'", fileName.c_str() );
+
+	return true;
+}
+
+/**
+ * @brief Disables the frame profiler.
+ * This function MUST be called before the engine shuts down.
+ */
+void ProfileDump::Shutdown()
+{
+	if ( m_pProfileSystem )
+	{
+		m_pProfileSystem->RemovePeaksListener( this );
+		m_pProfileSystem->Enable( false, false );
+		m_pProfileSystem = NULL;
+	}
+
+	if ( m_hFile )
+	{
+		CloseHandle( m_hFile );
+		m_hFile = NULL;
+	}
+}
+
+void ProfileDump::OnPreUpdate( float deltaTime, unsigned int frameID )
+{
+	if ( ! m_pProfileSystem )
+	{
+		return;
+	}
+
+	m_lastPeakLogTime += deltaTime;
+
+	if ( ! m_peaks.empty() )
+	{
+		// a single spike can trigger peaks of many sections
+		if ( m_lastPeakLogTime >= PROFILE_DUMP_PEAK_LOG_INTERVAL )
+		{
+			LogPeaks( frameID );
+			m_lastPeakLogTime = 0;
+		}
+
+		m_peaks.clear();
+	}
+
+	m_elapsedTime += deltaTime;
+	m_frameCount++;
+
+	const float interval = (m_pIntervalCVar) ? m_pIntervalCVar->GetFVal() : 0;
+
+	if ( interval > 0 && m_elapsedTime >= interval )
+	{
+		WriteToFile();
+
+		m_elapsedTime = 0;
+		m_frameCount = 0;
+	}
+}
+
+void ProfileDump::OnPostUpdate( float deltaTime, unsigned int frameID )
+{
+}
+
+void ProfileDump::OnFrameProfilerPeak( CFrameProfiler *pProfiler, float fPeakTime )
+{
+	if ( m_peaks.size() < PROFILE_DUMP_MAX_PEAKS )
+	{
+		Peak peak;
+		peak.pProfiler = pProfiler;
+		peak.peakTime = fPeakTime;
+
+		m_peaks.push_back( peak );
+	}
+}
@@ -0,0 +1,69 @@
+/**
+ * @file
+ * @brief Headless output of the engine frame profiler.
+ */
+
+#pragma once
+
+#include <vector>
+
+// CryEngine headers
+#include "FrameProfiler.h"
+
+// Launcher headers
+#include "ILauncherFrameListener.h"
+
+struct ICVar;
+
+/**
+ * @brief Writes statistics of engine frame profiler sections to a file and logs frames with peaks.
+ * All functions must be called only from main thread.
+ */
+class ProfileDump : public ILauncherFrameListener, public IFrameProfilePeakCallback
+{
+	struct Peak
+	{
+		CFrameProfiler *pProfiler;
+		float peakTime;
+	};
+
+	IFrameProfileSystem *m_pProfileSystem;
+	void *m_hFile;
+
+	ICVar *m_pIntervalCVar;
+	ICVar *m_pTopCountCVar;
+
+	std::vector<int64> m_lastSelfTimes;  //!< Total self time of each profiler at the last write to the file.
+	std::vector<Peak> m_peaks;           //!< Peaks of the last frame.
+
+	float m_elapsedTime;
+	float m_lastPeakLogTime;
+	unsigned int m_frameCount;
+
+	// disable implicit copy constructor and copy assignment operator
+	ProfileDump( const ProfileDump & );
+	ProfileDump & operator=( const ProfileDump & );
+
+	bool OpenFile( const char *fileName );
+	void WriteToFile();
+	void LogPeaks( unsigned int frameID );
+
+public:
+	ProfileDump();
+	~ProfileDump();
+
+	bool Init();
+	void Shutdown();
+
+	bool IsEnabled() const
+	{
+		return m_pProfileSystem != NULL;
+	}
+
+	// --- ILauncherFrameListener ---
+	void OnPreUpdate( float deltaTime, unsigned int frameID ) override;
+	void OnPostUpdate( float deltaTime, unsigned int frameID ) override;
+
+	// --- IFrameProfilePeakCallback ---
+	void OnFrameProfilerPeak( CFrameProfiler *pProfiler, float fPeakTime ) override;
+};
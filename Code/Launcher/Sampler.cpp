@@ -0,0 +1,642 @@
+/**
+ * @file
+ * @brief Implementation of sampling profiler of main thread.
+ *
+ * The sampler thread periodically suspends main thread, walks its stack and resumes it. Nothing that can take a lock
+ * held by main thread is done while it's suspended, so raw stacks are collected into the same buffer and counted only
+ * after main thread is resumed. Symbols are resolved once the sampling is stopped.
+ *
+ * 32-bit stacks are walked using the frame pointer chain, so callers of functions compiled without frame pointers may
+ * be missing. 64-bit stacks are unwound using the exception tables of the modules.
+ *
+ * The output file contains folded stacks ("root;caller;callee count" per line) that can be passed to flamegraph.pl.
+ */
+
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#include <mmsystem.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <map>
+#include <vector>
+
+// CryEngine headers
+#include "ISystem.h"
+#include "IConsole.h"
+
+// Launcher headers
+#include "Sampler.h"
+#include "SymbolTable.h"
+#include "LauncherEnv.h"
+#include "Clock.h"
+
+#define SAMPLER_MAX_RATE 1000  // limited by the system timer resolution
+
+#define SAMPLER_DEFAULT_FILE_NAME "Profile.folded"
+
+class Sampler::Impl
+{
+	typedef std::vector<void*> Stack;
+	typedef std::map<Stack, unsigned int> StackMap;
+
+	HANDLE m_hMainThread;
+	size_t m_stackBase;
+
+	HANDLE m_hThread;
+	HANDLE m_hStopEvent;
+	DWORD m_interval;
+	bool m_isTimerPeriodSet;
+
+	StackMap m_stacks;
+	unsigned int m_sampleCount;
+	unsigned int m_failedCount;
+	long long m_suspendTicks;  //!< Total time main thread was suspended.
+
+	std::string m_fileName;
+
+	CRITICAL_SECTION m_symbolLock;
+	SymbolTable m_symbols;
+
+	static DWORD WINAPI ThreadRoutine( LPVOID param );
+
+	void TakeSample();
+	int WalkStack( CONTEXT & context, void **frames, int maxFrames ) const;
+	bool WriteOutputFile();
+
+	void ResolveFrame( void *address, bool isReturnAddress, std::string & result );
+
+	static void OnProfileCmd( IConsoleCmdArgs *pArgs );
+
+public:
+	Impl()
+	: m_hMainThread(NULL),
+	  m_stackBase(0),
+	  m_hThread(NULL),
+	  m_hStopEvent(NULL),
+	  m_interval(1),
+	  m_isTimerPeriodSet(false),
+	  m_stacks(),
+	  m_sampleCount(0),
+	  m_failedCount(0),
+	  m_suspendTicks(0),
+	  m_fileName(),
+	  m_symbols()
+	{
+		InitializeCriticalSection( &m_symbolLock );
+
+		// the sampler is created by main thread
+		const NT_TIB *pTIB = static_cast<const NT_TIB*>( NtCurrentTeb() );
+		m_stackBase = reinterpret_cast<size_t>( pTIB->StackBase );
+
+		m_hMainThread = OpenThread( THREAD_SUSPEND_RESUME | THREAD_GET_CONTEXT | THREAD_QUERY_INFORMATION,
+		                            FALSE, gLauncher->mainThreadID );
+	}
+
+	~Impl()
+	{
+		// the output file is not written because the root folder and the modules may be gone already
+		StopThread();
+
+		if ( m_hMainThread )
+		{
+			CloseHandle( m_hMainThread );
+		}
+
+		DeleteCriticalSection( &m_symbolLock );
+	}
+
+	bool IsRunning() const
+	{
+		return m_hThread != NULL;
+	}
+
+	const char *GetFileName() const
+	{
+		return m_fileName.c_str();
+	}
+
+	unsigned int GetSampleCount() const
+	{
+		return m_sampleCount;
+	}
+
+	unsigned int GetStackCount() const
+	{
+		return static_cast<unsigned int>( m_stacks.size() );
+	}
+
+	bool Start( const char *fileName, unsigned int rate );
+	void StopThread();
+	bool Stop();
+
+	int CaptureMainThreadStack( void **frames, int maxFrames );
+	void FormatStack( void * const *frames, int frameCount, std::string & result );
+
+	void RegisterConsoleCommands();
+};
+
+DWORD WINAPI Sampler::Impl::ThreadRoutine( LPVOID param )  // static function
+{
+	Impl *self = static_cast<Impl*>( param );
+
+	while ( WaitForSingleObject( self->m_hStopEvent, self->m_interval ) == WAIT_TIMEOUT )
+	{
+		self->TakeSample();
+	}
+
+	return 0;
+}
+
+void Sampler::Impl::TakeSample()
+{
+	void *frames[MAX_FRAMES];
+
+	const long long startTime = Clock::GetTicks();
+
+	const int frameCount = CaptureMainThreadStack( frames, MAX_FRAMES );
+
+	m_suspendTicks += Clock::GetTicks() - startTime;
+
+	if ( frameCount <= 0 )
+	{
+		m_failedCount++;
+		return;
+	}
+
+	// main thread is running again, so allocations are safe here
+	m_stacks[Stack( frames, frames + frameCount )]++;
+	m_sampleCount++;
+}
+
+/**
+ * @brief Walks stack of suspended thread.
+ * Only the stack memory between the stack pointer and the stack base is read.
+ */
+int Sampler::Impl::WalkStack( CONTEXT & context, void **frames, int maxFrames ) const
+{
+	int count = 0;
+
+#ifdef BUILD_64BIT
+	const size_t stackLow = context.Rsp;
+
+	frames[count++] = reinterpret_cast<void*>( context.Rip );
+
+	while ( count < maxFrames )
+	{
+		DWORD64 imageBase = 0;
+		PRUNTIME_FUNCTION pFunction = RtlLookupFunctionEntry( context.Rip, &imageBase, NULL );
+
+		if ( pFunction )
+		{
+			PVOID handlerData = NULL;
+			DWORD64 establisherFrame = 0;
+
+			RtlVirtualUnwind( UNW_FLAG_NHANDLER, imageBase, context.Rip, pFunction, &context,
+			                  &handlerData, &establisherFrame, NULL );
+		}
+		else
+		{
+			// leaf function without stack frame
+			if ( context.Rsp < stackLow || context.Rsp + sizeof (DWORD64) > m_stackBase )
+			{
+				break;
+			}
+
+			context.Rip = *reinterpret_cast<const DWORD64*>( context.Rsp );
+			context.Rsp += sizeof (DWORD64);
+		}
+
+		if ( ! context.Rip || context.Rsp < stackLow || context.Rsp >= m_stackBase )
+		{
+			break;
+		}
+
+		frames[count++] = reinterpret_cast<void*>( context.Rip );
+	}
+#else
+	const size_t stackLow = context.Esp;
+
+	frames[count++] = reinterpret_cast<void*>( context.Eip );
+
+	size_t frame = context.Ebp;
+
+	while ( count < maxFrames )
+	{
+		// EBP is just another register in functions without frame pointer
+		if ( frame < stackLow || frame + 2 * sizeof (size_t) > m_stackBase || (frame & (sizeof (size_t) - 1)) )
+		{
+			break;
+		}
+
+		const size_t *pFrame = reinterpret_cast<const size_t*>( frame );
+		const size_t nextFrame = pFrame[0];
+		const size_t returnAddress = pFrame[1];
+
+		if ( ! returnAddress )
+		{
+			break;
+		}
+
+		frames[count++] = reinterpret_cast<void*>( returnAddress );
+
+		// the stack grows down
+		if ( nextFrame <= frame )
+		{
+			break;
+		}
+
+		frame = nextFrame;
+	}
+#endif
+
+	return count;
+}
+
+void Sampler::Impl::ResolveFrame( void *address, bool isReturnAddress, std::string & result )
+{
+	// return address can already point to the next function
+	const unsigned char *codeAddress = static_cast<const unsigned char*>( address );
+	if ( isReturnAddress )
+	{
+		codeAddress--;
+	}
+
+	m_symbols.Resolve( codeAddress, result );
+}
+
+/**
+ * @brief Writes the collected stacks as folded stacks.
+ * Different raw stacks can be the same after symbol resolution, so their counts are merged. Consecutive frames with
+ * the same name are merged too, because frames without known functions are resolved only to their modules.
+ */
+bool Sampler::Impl::WriteOutputFile()
+{
+	std::string filePath = gLauncher->rootFolder;
+	filePath += '\\';
+	filePath += m_fileName;
+
+	FILE *file = fopen( filePath.c_str(), "w" );
+	if ( ! file )
+	{
+		return false;
+	}
+
+	std::map<std::string, unsigned int> foldedStacks;
+	std::map<void*, std::string> frameNames;
+
+	EnterCriticalSection( &m_symbolLock );
+
+	// modules may have been loaded since the last time
+	m_symbols.Load();
+
+	for ( StackMap::const_iterator it = m_stacks.begin(); it != m_stacks.end(); ++it )
+	{
+		const Stack & stack = it->first;
+
+		std::string foldedStack;
+		const std::string *pLastName = NULL;
+
+		// from the outermost frame
+		for ( size_t i = stack.size(); i-- > 0; )
+		{
+			std::map<void*, std::string>::iterator nameIt = frameNames.find( stack[i] );
+
+			if ( nameIt == frameNames.end() )
+			{
+				nameIt = frameNames.insert( std::make_pair( stack[i], std::string() ) ).first;
+				ResolveFrame( stack[i], i > 0, nameIt->second );
+			}
+
+			if ( pLastName && *pLastName == nameIt->second )
+			{
+				continue;
+			}
+
+			if ( ! foldedStack.empty() )
+			{
+				foldedStack += ';';
+			}
+
+			foldedStack += nameIt->second;
+			pLastName = &nameIt->second;
+		}
+
+		foldedStacks[foldedStack] += it->second;
+	}
+
+	LeaveCriticalSection( &m_symbolLock );
+
+	for ( std::map<std::string, unsigned int>::const_iterator it = foldedStacks.begin(); it != foldedStacks.end(); ++it )
+	{
+		fprintf( file, "%s %u\n", it->first.c_str(), it->second );
+	}
+
+	fclose( file );
+
+	return true;
+}
+
+bool Sampler::Impl::Start( const char *fileName, unsigned int rate )
+{
+	if ( IsRunning() || ! m_hMainThread )
+	{
+		return false;
+	}
+
+	if ( rate == 0 || rate > SAMPLER_MAX_RATE )
+	{
+		rate = SAMPLER_MAX_RATE;
+	}
+
+	m_fileName = (fileName && *fileName) ? fileName : SAMPLER_DEFAULT_FILE_NAME;
+	m_interval = 1000 / rate;
+	m_stacks.clear();
+	m_sampleCount = 0;
+	m_failedCount = 0;
+	m_suspendTicks = 0;
+
+	m_hStopEvent = CreateEvent( NULL, TRUE, FALSE, NULL );
+	if ( ! m_hStopEvent )
+	{
+		return false;
+	}
+
+	// 1 ms system timer resolution is required for 1 kHz sampling
+	m_isTimerPeriodSet = (timeBeginPeriod( 1 ) == TIMERR_NOERROR);
+
+	m_hThread = CreateThread( NULL, 0, ThreadRoutine, this, 0, NULL );
+	if ( ! m_hThread )
+	{
+		StopThread();
+		return false;
+	}
+
+	// samples must be taken on time
+	SetThreadPriority( m_hThread, THREAD_PRIORITY_TIME_CRITICAL );
+
+	return true;
+}
+
+void Sampler::Impl::StopThread()
+{
+	if ( m_hThread )
+	{
+		SetEvent( m_hStopEvent );
+		WaitForSingleObject( m_hThread, INFINITE );
+		CloseHandle( m_hThread );
+		m_hThread = NULL;
+	}
+
+	if ( m_hStopEvent )
+	{
+		CloseHandle( m_hStopEvent );
+		m_hStopEvent = NULL;
+	}
+
+	if ( m_isTimerPeriodSet )
+	{
+		timeEndPeriod( 1 );
+		m_isTimerPeriodSet = false;
+	}
+}
+
+/**
+ * @return True if the output file was written, otherwise false.
+ */
+bool Sampler::Impl::Stop()
+{
+	if ( ! IsRunning() )
+	{
+		return false;
+	}
+
+	StopThread();
+
+	return WriteOutputFile();
+}
+
+/**
+ * @brief Captures current stack of main thread.
+ * Main thread is suspended for the time of the stack walk.
+ */
+int Sampler::Impl::CaptureMainThreadStack( void **frames, int maxFrames )
+{
+	if ( ! m_hMainThread || maxFrames <= 0 || GetCurrentThreadId() == gLauncher->mainThreadID )
+	{
+		return 0;
+	}
+
+	if ( SuspendThread( m_hMainThread ) == static_cast<DWORD>( -1 ) )
+	{
+		return 0;
+	}
+
+	int frameCount = 0;
+
+	CONTEXT context;
+	memset( &context, 0, sizeof context );
+	context.ContextFlags = CONTEXT_FULL;
+
+	// also waits until the thread is really suspended
+	if ( GetThreadContext( m_hMainThread, &context ) )
+	{
+		frameCount = WalkStack( context, frames, maxFrames );
+	}
+
+	ResumeThread( m_hMainThread );
+
+	return frameCount;
+}
+
+/**
+ * @brief Converts stack to text with one frame per line.
+ */
+void Sampler::Impl::FormatStack( void * const *frames, int frameCount, std::string & result )
+{
+	std::string name;
+
+	EnterCriticalSection( &m_symbolLock );
+
+	if ( ! m_symbols.IsLoaded() )
+	{
+		m_symbols.Load();
+	}
+
+	for ( int i = 0; i < frameCount; i++ )
+	{
+		ResolveFrame( frames[i], i > 0, name );
+
+		char address[32];
+		sprintf( address, "  %p  ", frames[i] );
+
+		result += address;
+		result += name;
+		result += '\n';
+	}
+
+	LeaveCriticalSection( &m_symbolLock );
+}
+
+void Sampler::Impl::OnProfileCmd( IConsoleCmdArgs *pArgs )  // static function
+{
+	Impl *self = gLauncher->pSampler->m_impl;
+
+	const char *action = (pArgs->GetArgCount() > 1) ? pArgs->GetArg( 1 ) : "";
+
+	if ( strcmp( action, "start" ) == 0 )
+	{
+		const char *fileName = (pArgs->GetArgCount() > 2) ? pArgs->GetArg( 2 ) : NULL;
+
+		unsigned int rate = DEFAULT_RATE;
+		if ( pArgs->GetArgCount() > 3 && atoi( pArgs->GetArg( 3 ) ) > 0 )
+		{
+			rate = atoi( pArgs->GetArg( 3 ) );
+		}
+
+		if ( self->IsRunning() )
+		{
+			CryLogAlways( "Sampling profiler is already running" );
+		}
+		else if ( self->Start( fileName, rate ) )
+		{
+			CryLogAlways( "Sampling profiler started: interval = %lu ms", self->m_interval );
+		}
+		else
+		{
+			CryLogAlways( "$4[Error] Unable to start sampling profiler: error code %lu", GetLastError() );
+		}
+	}
+	else if ( strcmp( action, "stop" ) == 0 )
+	{
+		if ( ! self->IsRunning() )
+		{
+			CryLogAlways( "Sampling profiler is not running" );
+		}
+		else if ( self->Stop() )
+		{
+			CryLogAlways( "Sampling profiler stopped: samples = %u | stacks = %u | file = %s",
+			  self->GetSampleCount(), self->GetStackCount(), self->GetFileName() );
+		}
+		else
+		{
+			CryLogAlways( "$4[Error] Unable to write sampling profiler output file '%s'", self->GetFileName() );
+		}
+	}
+	else
+	{
+		const double suspendTime = (self->m_sampleCount + self->m_failedCount > 0)
+		  ? Clock::TicksToSeconds( self->m_suspendTicks ) * 1000000 / (self->m_sampleCount + self->m_failedCount) : 0;
+
+		CryLogAlways( "$3Sampling profiler: %s | interval = %lu ms", (self->IsRunning()) ? "running" : "stopped",
+		  self->m_interval );
+		CryLogAlways( "Samples = %u | failed = %u | stacks = %u | average pause = %.1f us",
+		  self->m_sampleCount, self->m_failedCount, self->GetStackCount(), suspendTime );
+		CryLogAlways( "Symbols = %u in %u modules",
+		  static_cast<unsigned int>( self->m_symbols.GetSymbolCount() ),
+		  static_cast<unsigned int>( self->m_symbols.GetModuleCount() ) );
+	}
+}
+
+void Sampler::Impl::RegisterConsoleCommands()
+{
+	IConsole *pConsole = gLauncher->pSystem->GetIConsole();
+
+	pConsole->AddCommand( "launcher_profile", OnProfileCmd, 0,
+	  "Controls sampling profiler of main thread. Output is written to the root folder as folded stacks.\n"
+	  "Usage: launcher_profile start [file] [rate]\n"
+	  "       launcher_profile stop\n"
+	  "       launcher_profile (shows status)\n"
+	  "Default file is " SAMPLER_DEFAULT_FILE_NAME " and default rate is 1000 samples per second."
+	);
+}
+
+/**
+ * @brief Constructor.
+ * This function MUST be called only from main thread.
+ */
+Sampler::Sampler()
+: m_impl(new Impl())
+{
+}
+
+/**
+ * @brief Destructor.
+ * Stops the sampling if it's still running.
+ */
+Sampler::~Sampler()
+{
+	delete m_impl;
+}
+
+/**
+ * @brief Starts sampling of main thread.
+ * This function MUST be called only from main thread.
+ * @param fileName Name of the output file in the root folder or NULL to use the default one.
+ * @param rate Number of samples per second. It's limited to 1000.
+ * @return True if the sampling was started, otherwise false.
+ */
+bool Sampler::Start( const char *fileName, unsigned int rate )
+{
+	return m_impl->Start( fileName, rate );
+}
+
+/**
+ * @brief Stops the sampling and writes the output file.
+ * This function MUST be called only from main thread before modules are unloaded.
+ * @return True if the output file was written, otherwise false.
+ */
+bool Sampler::Stop()
+{
+	return m_impl->Stop();
+}
+
+bool Sampler::IsRunning() const
+{
+	return m_impl->IsRunning();
+}
+
+const char *Sampler::GetFileName() const
+{
+	return m_impl->GetFileName();
+}
+
+unsigned int Sampler::GetSampleCount() const
+{
+	return m_impl->GetSampleCount();
+}
+
+unsigned int Sampler::GetStackCount() const
+{
+	return m_impl->GetStackCount();
+}
+
+/**
+ * @brief Captures current stack of main thread.
+ * This function can be called from any thread except main thread.
+ * @param frames Receives code addresses starting from the innermost frame.
+ * @param maxFrames Maximum number of frames.
+ * @return Number of captured frames or 0 if the capture failed.
+ */
+int Sampler::CaptureMainThreadStack( void **frames, int maxFrames )
+{
+	return m_impl->CaptureMainThreadStack( frames, maxFrames );
+}
+
+/**
+ * @brief Appends stack captured by CaptureMainThreadStack to text with one "address module!function" per line.
+ * This function can be called from any thread, but it MUST NOT be called while main thread is suspended.
+ */
+void Sampler::FormatStack( void * const *frames, int frameCount, std::string & result )
+{
+	m_impl->FormatStack( frames, frameCount, result );
+}
+
+/**
+ * @brief Registers sampling profiler console commands.
+ * This function MUST be called only from main thread after the engine console is created.
+ */
+void Sampler::RegisterConsoleCommands()
+{
+	m_impl->RegisterConsoleCommands();
+}
@@ -0,0 +1,38 @@
+/**
+ * @file
+ * @brief Sampling profiler of main thread.
+ */
+
+#pragma once
+
+#include <string>
+
+class Sampler
+{
+	class Impl;
+	Impl *m_impl;  // std::unique_ptr is C++11
+
+	// disable implicit copy constructor and copy assignment operator
+	Sampler( const Sampler & );
+	Sampler & operator=( const Sampler & );
+
+public:
+	static const unsigned int DEFAULT_RATE = 1000;
+	static const int MAX_FRAMES = 64;
+
+	Sampler();
+	~Sampler();
+
+	bool Start( const char *fileName, unsigned int rate = DEFAULT_RATE );
+	bool Stop();
+
+	bool IsRunning() const;
+	const char *GetFileName() const;
+	unsigned int GetSampleCount() const;
+	unsigned int GetStackCount() const;
+
+	int CaptureMainThreadStack( void **frames, int maxFrames );
+	void FormatStack( void * const *frames, int frameCount, std::string & result );
+
+	void RegisterConsoleCommands();
+};
@@ -11,6 +11,9 @@
 // Library headers
 #include "printf/printf.h"
 
+// Launcher headers
+#include "FastFormat.h"
+
 // va_copy is available only in VS2013 and later
 #if defined(_MSC_VER) && _MSC_VER < 1800
 #define va_copy(dest,src) ((dest) = (src))  // dirty haxs
@@ -138,6 +141,24 @@ public:
 		m_buffer[m_pos] = '\0';
 	}
 
+	/**
+	 * @brief Reserves space at the end of the buffer to be filled directly.
+	 * @param maxLength Maximum number of characters that will be written.
+	 * @return Pointer to the reserved space. Call endAppend with the actual length afterwards.
+	 */
+	char *beginAppend( size_t maxLength )
+	{
+		makeSpaceFor( maxLength );
+
+		return m_buffer + m_pos;
+	}
+
+	void endAppend( size_t length )
+	{
+		m_pos += length;
+		m_buffer[m_pos] = '\0';
+	}
+
 	template<size_t U>
 	void append( const StringBuffer<U> & other )
 	{
@@ -215,6 +236,66 @@ public:
 		return status;
 	}
 
+	/**
+	 * @brief Appends unsigned integer like "%u" or "%0<Width>u" without format string parsing.
+	 * @tparam Width Minimum number of characters.
+	 * @tparam Pad Padding character. Either space or zero.
+	 */
+	template<unsigned int Width, char Pad>
+	void append_uint( unsigned long long value )
+	{
+		// compile-time check of the padding character
+		typedef char PadCheck[(Pad == ' ' || Pad == '0') ? 1 : -1];
+
+		char *dest = beginAppend( (Width > FastFormat::MAX_INT_LENGTH) ? Width : FastFormat::MAX_INT_LENGTH );
+
+		endAppend( FastFormat::FormatUInt( dest, value, Width, Pad ) );
+	}
+
+	void append_uint( unsigned long long value )
+	{
+		append_uint<0, ' '>( value );
+	}
+
+	/**
+	 * @brief Appends signed integer like "%d" or "%0<Width>d" without format string parsing.
+	 * @tparam Width Minimum number of characters including the sign.
+	 * @tparam Pad Padding character. Either space or zero.
+	 */
+	template<unsigned int Width, char Pad>
+	void append_int( long long value )
+	{
+		// compile-time check of the padding character
+		typedef char PadCheck[(Pad == ' ' || Pad == '0') ? 1 : -1];
+
+		char *dest = beginAppend( (Width > FastFormat::MAX_INT_LENGTH) ? Width : FastFormat::MAX_INT_LENGTH );
+
+		endAppend( FastFormat::FormatInt( dest, value, Width, Pad ) );
+	}
+
+	void append_int( long long value )
+	{
+		append_int<0, ' '>( value );
+	}
+
+	/**
+	 * @brief Appends floating-point number like "%<Width>.<Precision>f" without format string parsing.
+	 * The output is the same as the output of append_f with the equivalent format string, except for exact halfway
+	 * cases that round up to the next whole number, e.g. 0.95 with precision 1 is "1.0" here and "0.10" in append_f.
+	 * @tparam Precision Number of digits after the decimal point.
+	 * @tparam Width Minimum number of characters.
+	 */
+	template<unsigned int Precision, unsigned int Width>
+	void append_fixed( double value )
+	{
+		// compile-time check of the precision
+		typedef char PrecisionCheck[(Precision <= FastFormat::MAX_PRECISION) ? 1 : -1];
+
+		char *dest = beginAppend( (Width > FastFormat::MAX_FIXED_LENGTH) ? Width : FastFormat::MAX_FIXED_LENGTH );
+
+		endAppend( FastFormat::FormatFixed( dest, value, Precision, Width ) );
+	}
+
 	void makeSpaceFor( size_t length )
 	{
 		if ( length > getAvailableLength() )
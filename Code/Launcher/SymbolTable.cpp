@@ -0,0 +1,285 @@
+/**
+ * @file
+ * @brief Implementation of symbols of loaded modules.
+ *
+ * CryEngine modules export only a few functions, so exports alone give only a rough idea where the code is. A map file
+ * generated by the linker (/MAP) makes the names exact. It must have the same name as the module with ".map" extension.
+ * Addresses in the map file are relative to the preferred load address, which is also written in the file.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#include <tlhelp32.h>
+#include <dbghelp.h>
+
+// Launcher headers
+#include "SymbolTable.h"
+#include "Util.h"
+
+static bool IsSymbolModule( const MODULEENTRY32 & entry )
+{
+	// CryEngine modules and the launcher itself
+	return _strnicmp( entry.szModule, "Cry", 3 ) == 0 || entry.hModule == GetModuleHandleA( NULL );
+}
+
+static char *SkipSpaces( char *text )
+{
+	while ( *text == ' ' || *text == '\t' )
+	{
+		text++;
+	}
+
+	return text;
+}
+
+static char *ReadToken( char *& text )
+{
+	char *token = SkipSpaces( text );
+
+	char *end = token;
+	while ( *end && *end != ' ' && *end != '\t' && *end != '\r' && *end != '\n' )
+	{
+		end++;
+	}
+
+	text = (*end) ? end + 1 : end;
+	(*end) = '\0';
+
+	return token;
+}
+
+SymbolTable::SymbolTable()
+: m_modules(),
+  m_symbolCount(0),
+  m_isLoaded(false)
+{
+}
+
+/**
+ * @brief Reads names of exported functions from the module loaded in memory.
+ */
+void SymbolTable::LoadExports( Module & module )  // static function
+{
+	const void *base = reinterpret_cast<const void*>( module.base );
+
+	const IMAGE_DOS_HEADER *pDOSHeader = static_cast<const IMAGE_DOS_HEADER*>( base );
+	if ( pDOSHeader->e_magic != IMAGE_DOS_SIGNATURE )
+	{
+		return;
+	}
+
+	const IMAGE_NT_HEADERS *pNTHeaders = static_cast<const IMAGE_NT_HEADERS*>(
+	  Util::CalculateAddress( base, pDOSHeader->e_lfanew ) );
+	if ( pNTHeaders->Signature != IMAGE_NT_SIGNATURE )
+	{
+		return;
+	}
+
+	const IMAGE_DATA_DIRECTORY & directory = pNTHeaders->OptionalHeader.DataDirectory[IMAGE_DIRECTORY_ENTRY_EXPORT];
+	if ( directory.VirtualAddress == 0 || directory.Size == 0 )
+	{
+		return;
+	}
+
+	const IMAGE_EXPORT_DIRECTORY *pExports = static_cast<const IMAGE_EXPORT_DIRECTORY*>(
+	  Util::CalculateAddress( base, directory.VirtualAddress ) );
+
+	const DWORD *functions = static_cast<const DWORD*>( Util::CalculateAddress( base, pExports->AddressOfFunctions ) );
+	const DWORD *names = static_cast<const DWORD*>( Util::CalculateAddress( base, pExports->AddressOfNames ) );
+	const WORD *ordinals = static_cast<const WORD*>( Util::CalculateAddress( base, pExports->AddressOfNameOrdinals ) );
+
+	for ( DWORD i = 0; i < pExports->NumberOfNames; i++ )
+	{
+		if ( ordinals[i] >= pExports->NumberOfFunctions )
+		{
+			continue;
+		}
+
+		const DWORD rva = functions[ordinals[i]];
+
+		// forwarded export
+		if ( rva >= directory.VirtualAddress && rva < directory.VirtualAddress + directory.Size )
+		{
+			continue;
+		}
+
+		Symbol symbol;
+		symbol.address = module.base + rva;
+		symbol.name = static_cast<const char*>( Util::CalculateAddress( base, names[i] ) );
+
+		module.symbols.push_back( symbol );
+	}
+}
+
+/**
+ * @brief Reads public and static symbols from the map file of the module.
+ * @return True if the map file was loaded, otherwise false.
+ */
+bool SymbolTable::LoadMapFile( Module & module, const std::string & modulePath )  // static function
+{
+	std::string mapPath = modulePath;
+
+	const size_t dotPos = mapPath.rfind( '.' );
+	if ( dotPos != std::string::npos && mapPath.find( '\\', dotPos ) == std::string::npos )
+	{
+		mapPath.erase( dotPos );
+	}
+
+	mapPath += ".map";
+
+	FILE *file = fopen( mapPath.c_str(), "r" );
+	if ( ! file )
+	{
+		return false;
+	}
+
+	unsigned long long preferredBase = 0;
+	bool isSymbols = false;
+
+	char line[1024];
+	while ( fgets( line, sizeof line, file ) )
+	{
+		if ( ! isSymbols )
+		{
+			const char *preferredBaseText = strstr( line, "Preferred load address is " );
+			if ( preferredBaseText )
+			{
+				preferredBase = _strtoui64( preferredBaseText + 26, NULL, 16 );
+			}
+			else if ( strstr( line, "Publics by Value" ) )
+			{
+				isSymbols = true;
+			}
+
+			continue;
+		}
+
+		// " 0001:00000000       ?Update@CSystem@@UAE_NHH@Z    10001000 f   System.obj"
+		char *text = line;
+		const char *section = ReadToken( text );
+		char *name = ReadToken( text );
+		const char *address = ReadToken( text );
+
+		if ( ! strchr( section, ':' ) || ! *name || ! *address )
+		{
+			continue;
+		}
+
+		const unsigned long long rvaBase = _strtoui64( address, NULL, 16 );
+		if ( rvaBase < preferredBase || rvaBase - preferredBase >= module.size )
+		{
+			continue;
+		}
+
+		Symbol symbol;
+		symbol.address = module.base + static_cast<size_t>( rvaBase - preferredBase );
+
+		char undecoratedName[512];
+		if ( name[0] == '?' && UnDecorateSymbolName( name, undecoratedName, sizeof undecoratedName, UNDNAME_NAME_ONLY ) )
+		{
+			symbol.name = undecoratedName;
+		}
+		else
+		{
+			// C function names have leading underscore in 32-bit modules
+			symbol.name = (name[0] == '_') ? name + 1 : name;
+		}
+
+		module.symbols.push_back( symbol );
+	}
+
+	fclose( file );
+
+	return true;
+}
+
+/**
+ * @brief Loads modules of the process and their symbols.
+ * Modules loaded later are unknown.
+ * @return True if successful, otherwise false.
+ */
+bool SymbolTable::Load()
+{
+	HANDLE hSnapshot = CreateToolhelp32Snapshot( TH32CS_SNAPMODULE, 0 );
+	if ( hSnapshot == INVALID_HANDLE_VALUE )
+	{
+		return false;
+	}
+
+	m_modules.clear();
+	m_symbolCount = 0;
+
+	MODULEENTRY32 entry;
+	entry.dwSize = sizeof entry;
+
+	for ( BOOL hasEntry = Module32First( hSnapshot, &entry ); hasEntry; hasEntry = Module32Next( hSnapshot, &entry ) )
+	{
+		m_modules.push_back( Module() );
+
+		Module & module = m_modules.back();
+		module.base = reinterpret_cast<size_t>( entry.modBaseAddr );
+		module.size = entry.modBaseSize;
+		module.name = entry.szModule;
+
+		if ( IsSymbolModule( entry ) )
+		{
+			LoadExports( module );
+			LoadMapFile( module, entry.szExePath );
+
+			std::sort( module.symbols.begin(), module.symbols.end() );
+
+			m_symbolCount += module.symbols.size();
+		}
+	}
+
+	CloseHandle( hSnapshot );
+
+	std::sort( m_modules.begin(), m_modules.end() );
+
+	m_isLoaded = true;
+
+	return true;
+}
+
+/**
+ * @brief Converts code address to "module!function" or to module name if the function is unknown.
+ * @param address The address.
+ * @param result Receives the name.
+ */
+void SymbolTable::Resolve( const void *address, std::string & result ) const
+{
+	const size_t value = reinterpret_cast<size_t>( address );
+
+	Module key;
+	key.base = value;
+
+	// the last module starting at or below the address
+	std::vector<Module>::const_iterator moduleIt = std::upper_bound( m_modules.begin(), m_modules.end(), key );
+
+	if ( moduleIt == m_modules.begin() || value - (moduleIt - 1)->base >= (moduleIt - 1)->size )
+	{
+		result = "[unknown]";
+		return;
+	}
+
+	const Module & module = *(moduleIt - 1);
+
+	result = module.name;
+
+	Symbol symbolKey;
+	symbolKey.address = value;
+
+	std::vector<Symbol>::const_iterator symbolIt;
+	symbolIt = std::upper_bound( module.symbols.begin(), module.symbols.end(), symbolKey );
+
+	if ( symbolIt != module.symbols.begin() )
+	{
+		result += '!';
+		result += (symbolIt - 1)->name;
+	}
+}
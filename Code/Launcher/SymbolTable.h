@@ -0,0 +1,72 @@
+/**
+ * @file
+ * @brief Symbols of loaded modules.
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Converts code addresses to names of functions.
+ * Functions are known only for CryEngine modules and the launcher. They're taken from module exports and from map
+ * files placed next to the modules. Other addresses are converted to module names.
+ * Once loaded, the table can be used from any thread.
+ */
+class SymbolTable
+{
+	struct Symbol
+	{
+		size_t address;
+		std::string name;
+
+		bool operator<( const Symbol & other ) const
+		{
+			return address < other.address;
+		}
+	};
+
+	struct Module
+	{
+		size_t base;
+		size_t size;
+		std::string name;
+		std::vector<Symbol> symbols;  //!< Sorted by address.
+
+		bool operator<( const Module & other ) const
+		{
+			return base < other.base;
+		}
+	};
+
+	std::vector<Module> m_modules;  //!< Sorted by base address.
+	size_t m_symbolCount;
+	bool m_isLoaded;
+
+	static void LoadExports( Module & module );
+	static bool LoadMapFile( Module & module, const std::string & modulePath );
+
+public:
+	SymbolTable();
+
+	bool Load();
+
+	bool IsLoaded() const
+	{
+		return m_isLoaded;
+	}
+
+	size_t GetModuleCount() const
+	{
+		return m_modules.size();
+	}
+
+	size_t GetSymbolCount() const
+	{
+		return m_symbolCount;
+	}
+
+	void Resolve( const void *address, std::string & result ) const;
+};
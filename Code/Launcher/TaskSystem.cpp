@@ -3,74 +3,312 @@
  * @brief Implementation of launcher task system.
  */
 
+#include <string.h>
 #include <new>
-#include <deque>
 
-#define WIN32_LEAN_AND_MEAN
-#include <windows.h>
+// CryEngine headers
+#include "ISystem.h"
+#include "IConsole.h"
+#include "ITimer.h"
 
 // Launcher headers
 #include "TaskSystem.h"
-#include "ILauncherTask.h"
+#include "LauncherEnv.h"
+#include "LockFreeQueue.h"
+#include "MemoryPool.h"
+#include "TimerWheel.h"
+#include "Clock.h"
 
-class LockGuard
+#define TASK_NODE_POOL_SIZE 1024
+
+class TaskSystem::Impl
 {
-	CRITICAL_SECTION *m_pCriticalSection;
+	/**
+	 * @brief Queue node of a task.
+	 * ILauncherTask cannot contain the link itself because it is part of the launcher API.
+	 */
+	struct TaskNode : public LockFreeQueueNode
+	{
+		ILauncherTask *pTask;
+
+		TaskNode( ILauncherTask *task )
+		: LockFreeQueueNode(),
+		  pTask(task)
+		{
+		}
+	};
+
+	struct Stats
+	{
+		unsigned int lastBatchSize[eLTP_Count];
+		unsigned int maxBatchSize[eLTP_Count];
+		unsigned int executedCount[eLTP_Count];
+		unsigned int deferredCount;     //!< Total number of times a task was deferred to the next frame.
+		unsigned int deferredFrames;    //!< Number of frames with deferred tasks.
+		unsigned int maxDeferredDepth;  //!< Maximum number of tasks deferred at once.
+	};
+
+	LockFreeQueue m_queues[eLTP_Count];
+
+	// recycled queue nodes, so dispatching a task from other threads allocates only the task itself
+	MemoryPool m_nodePool;
+
+	// low priority tasks deferred to later frames
+	LockFreeQueueNode *m_pDeferredFirst;
+	LockFreeQueueNode *m_pDeferredLast;
+	unsigned int m_deferredDepth;
+
+	// delayed and periodic tasks, one tick is one millisecond
+	TimerWheel m_timerWheel;
+
+	ICVar *m_pBudgetCVar;
+
+	Stats m_stats;
+
+	static unsigned long long GetCurrentTick()
+	{
+		return Clock::GetTicks() / (Clock::GetFrequency() / 1000);
+	}
+
+	void ExecuteTask( LockFreeQueueNode *pNode );
+
+	unsigned int ExecuteAll( LockFreeQueueNode *pNode );
+	unsigned int AddDeferred( LockFreeQueueNode *pNode );
+	unsigned int ExecuteDeferred( const CTimeValue & startTime, float budget );
+
+	static void OnTaskStatsCmd( IConsoleCmdArgs *pArgs );
 
 public:
-	LockGuard( CRITICAL_SECTION & criticalSection )
-	: m_pCriticalSection(&criticalSection)
+	Impl()
+	: m_nodePool(),
+	  m_pDeferredFirst(NULL),
+	  m_pDeferredLast(NULL),
+	  m_deferredDepth(0),
+	  m_timerWheel(),
+	  m_pBudgetCVar(NULL)
+	{
+		m_timerWheel.Init( GetCurrentTick() );
+
+		// heap is used if this fails
+		m_nodePool.Init( sizeof (TaskNode), TASK_NODE_POOL_SIZE );
+
+		ResetStats();
+	}
+
+	void PushTask( ILauncherTask *pTask, ELauncherTaskPriority priority )
+	{
+		if ( priority < 0 || priority >= eLTP_Count )
+		{
+			priority = eLTP_Normal;
+		}
+
+		void *pMemory = m_nodePool.Alloc( sizeof (TaskNode) );
+
+		m_queues[priority].Push( new (pMemory) TaskNode( pTask ) );
+	}
+
+	unsigned int AddTimer( ILauncherTask *pTask, unsigned int delay, unsigned int interval )
 	{
-		EnterCriticalSection( m_pCriticalSection );
+		return m_timerWheel.Add( pTask, delay, interval );
 	}
 
-	~LockGuard()
+	bool CancelTimer( unsigned int handle )
 	{
-		LeaveCriticalSection( m_pCriticalSection );
+		return m_timerWheel.Cancel( handle );
 	}
+
+	void ResetStats()
+	{
+		memset( &m_stats, 0, sizeof m_stats );
+	}
+
+	void ExecuteWaitingTasks();
+
+	void RegisterConsoleCommands();
 };
 
-class TaskSystem::Impl
+void TaskSystem::Impl::ExecuteTask( LockFreeQueueNode *pNode )
 {
-	std::deque<ILauncherTask*> m_queue;
-	CRITICAL_SECTION m_criticalSection;
+	TaskNode *pTaskNode = static_cast<TaskNode*>( pNode );
+	ILauncherTask *pTask = pTaskNode->pTask;
 
-public:
-	Impl()
-	: m_queue(),
-	  m_criticalSection()
+	// the node is recycled before the task runs, so tasks dispatching other tasks can reuse it
+	pTaskNode->~TaskNode();
+	m_nodePool.Free( pTaskNode );
+
+	pTask->Run();
+	// destroy the task
+	delete pTask;
+}
+
+unsigned int TaskSystem::Impl::ExecuteAll( LockFreeQueueNode *pNode )
+{
+	unsigned int count = 0;
+
+	while ( pNode )
 	{
-		InitializeCriticalSection( &m_criticalSection );
+		LockFreeQueueNode *pNext = pNode->pNext;
+		ExecuteTask( pNode );
+		pNode = pNext;
+		count++;
 	}
 
-	~Impl()
+	return count;
+}
+
+unsigned int TaskSystem::Impl::AddDeferred( LockFreeQueueNode *pNode )
+{
+	unsigned int count = 0;
+
+	if ( pNode )
 	{
-		DeleteCriticalSection( &m_criticalSection );
+		if ( m_pDeferredLast )
+		{
+			m_pDeferredLast->pNext = pNode;
+		}
+		else
+		{
+			m_pDeferredFirst = pNode;
+		}
+
+		for ( count = 1; pNode->pNext; count++ )
+		{
+			pNode = pNode->pNext;
+		}
+
+		m_pDeferredLast = pNode;
+		m_deferredDepth += count;
 	}
 
-	void PushTask( ILauncherTask *pTask )
+	return count;
+}
+
+unsigned int TaskSystem::Impl::ExecuteDeferred( const CTimeValue & startTime, float budget )
+{
+	ITimer *pTimer = (gLauncher->pSystem) ? gLauncher->pSystem->GetITimer() : NULL;
+
+	unsigned int count = 0;
+
+	while ( m_pDeferredFirst )
 	{
-		LockGuard lock( m_criticalSection );
+		// at least one task is always executed to make some progress
+		if ( count > 0 && budget > 0 && pTimer )
+		{
+			if ( (pTimer->GetAsyncTime() - startTime).GetMilliSeconds() >= budget )
+			{
+				break;
+			}
+		}
+
+		LockFreeQueueNode *pNode = m_pDeferredFirst;
+
+		m_pDeferredFirst = pNode->pNext;
+		if ( ! m_pDeferredFirst )
+		{
+			m_pDeferredLast = NULL;
+		}
+
+		m_deferredDepth--;
+
+		ExecuteTask( pNode );
+		count++;
+	}
 
-		m_queue.push_back( pTask );
+	return count;
+}
+
+void TaskSystem::Impl::ExecuteWaitingTasks()
+{
+	const float budget = (m_pBudgetCVar) ? m_pBudgetCVar->GetFVal() : 0;
+
+	CTimeValue startTime;
+	if ( budget > 0 && gLauncher->pSystem )
+	{
+		startTime = gLauncher->pSystem->GetITimer()->GetAsyncTime();
 	}
 
-	ILauncherTask *PopTask()
+	// tasks added by the executed tasks are executed in the next call
+	unsigned int count[eLTP_Count];
+	count[eLTP_High] = ExecuteAll( m_queues[eLTP_High].PopAll() );
+	count[eLTP_Normal] = ExecuteAll( m_queues[eLTP_Normal].PopAll() );
+	count[eLTP_Low] = AddDeferred( m_queues[eLTP_Low].PopAll() );
+
+	m_timerWheel.Advance( GetCurrentTick() );
+
+	m_stats.executedCount[eLTP_High] += count[eLTP_High];
+	m_stats.executedCount[eLTP_Normal] += count[eLTP_Normal];
+	m_stats.executedCount[eLTP_Low] += ExecuteDeferred( startTime, budget );
+
+	for ( int i = 0; i < eLTP_Count; i++ )
 	{
-		LockGuard lock( m_criticalSection );
+		m_stats.lastBatchSize[i] = count[i];
 
-		if ( m_queue.empty() )
+		if ( count[i] > m_stats.maxBatchSize[i] )
 		{
-			return NULL;
+			m_stats.maxBatchSize[i] = count[i];
 		}
-		else
+	}
+
+	if ( m_deferredDepth > 0 )
+	{
+		m_stats.deferredCount += m_deferredDepth;
+		m_stats.deferredFrames++;
+
+		if ( m_deferredDepth > m_stats.maxDeferredDepth )
 		{
-			ILauncherTask *pTask = m_queue.front();
-			m_queue.pop_front();
-			return pTask;
+			m_stats.maxDeferredDepth = m_deferredDepth;
 		}
 	}
-};
+}
+
+void TaskSystem::Impl::OnTaskStatsCmd( IConsoleCmdArgs *pArgs )  // static function
+{
+	Impl *self = gLauncher->pTaskSystem->m_impl;
+
+	if ( pArgs->GetArgCount() > 1 && strcmp( pArgs->GetArg( 1 ), "reset" ) == 0 )
+	{
+		self->ResetStats();
+		CryLogAlways( "Launcher task statistics reset" );
+		return;
+	}
+
+	const Stats & stats = self->m_stats;
+	const char *names[eLTP_Count] = { "High", "Normal", "Low" };
+
+	CryLogAlways( "$3Launcher tasks: budget = %.2f ms", (self->m_pBudgetCVar) ? self->m_pBudgetCVar->GetFVal() : 0 );
+
+	for ( int i = 0; i < eLTP_Count; i++ )
+	{
+		CryLogAlways( "%-6s | executed = %u | last batch = %u | max batch = %u",
+		  names[i], stats.executedCount[i], stats.lastBatchSize[i], stats.maxBatchSize[i] );
+	}
+
+	CryLogAlways( "Deferred | current depth = %u | max depth = %u | total = %u | frames = %u",
+	  self->m_deferredDepth, stats.maxDeferredDepth, stats.deferredCount, stats.deferredFrames );
+
+	CryLogAlways( "Timers | active = %u | executed = %u | cascaded = %u", self->m_timerWheel.GetActiveCount(),
+	  self->m_timerWheel.GetExecutedCount(), self->m_timerWheel.GetCascadedCount() );
+
+	CryLogAlways( "Node pool | used = %ld/%lu | overflow = %ld", self->m_nodePool.GetUsedCount(),
+	  static_cast<unsigned long>( self->m_nodePool.GetBlockCount() ), self->m_nodePool.GetOverflowCount() );
+}
+
+void TaskSystem::Impl::RegisterConsoleCommands()
+{
+	IConsole *pConsole = gLauncher->pSystem->GetIConsole();
+
+	m_pBudgetCVar = pConsole->RegisterFloat( "launcher_TaskBudget", 0, VF_NOT_NET_SYNCED,
+	  "Time budget in milliseconds for low priority launcher tasks executed in one frame.\n"
+	  "Remaining low priority tasks are deferred to later frames.\n"
+	  "Usage: launcher_TaskBudget [ms]\n"
+	  "  0 = Unlimited (default)."
+	);
+
+	pConsole->AddCommand( "launcher_taskstats", OnTaskStatsCmd, 0,
+	  "Shows launcher task queue depth and deferral counters.\n"
+	  "Usage: launcher_taskstats [reset]"
+	);
+}
 
 /**
  * @brief Constructor.
@@ -90,31 +328,69 @@ TaskSystem::~TaskSystem()
 
 /**
  * @brief Adds task to the queue.
- * This function can be called from any thread.
+ * This function can be called from any thread. It never blocks.
  * @param pTask The task allocated on heap using the "new" operator.
+ * @param priority The task priority.
  */
-void TaskSystem::AddTask( ILauncherTask *pTask )
+void TaskSystem::AddTask( ILauncherTask *pTask, ELauncherTaskPriority priority )
 {
 	if ( pTask )
 	{
-		m_impl->PushTask( pTask );
+		m_impl->PushTask( pTask, priority );
 	}
 }
 
 /**
- * @brief Executes callbacks of all waiting tasks and removes them from the queue.
+ * @brief Schedules task to be executed after some time.
  * This function MUST be called only from main thread.
+ * @param pTask The task allocated on heap using the "new" operator.
+ * @param delay Time in milliseconds until the first execution.
+ * @param interval Time in milliseconds between executions of periodic task or 0 to execute the task only once.
+ * @return Handle of the timer or 0 if the task was not scheduled and the caller still owns it.
  */
-void TaskSystem::ExecuteWaitingTasks()
+unsigned int TaskSystem::AddTimer( ILauncherTask *pTask, unsigned int delay, unsigned int interval )
 {
-	ILauncherTask *pTask = m_impl->PopTask();
-	while ( pTask )
+	if ( ! pTask || ! IsMainThread() )
 	{
-		pTask->Run();
-		// destroy the task
-		delete pTask;
+		return 0;
+	}
+
+	return m_impl->AddTimer( pTask, delay, interval );
+}
 
-		pTask = m_impl->PopTask();
+/**
+ * @brief Cancels scheduled task and destroys it.
+ * This function MUST be called only from main thread.
+ * @param handle Handle of the timer.
+ * @return True if the task was cancelled, otherwise false.
+ */
+bool TaskSystem::CancelTimer( unsigned int handle )
+{
+	if ( ! IsMainThread() )
+	{
+		return false;
 	}
+
+	return m_impl->CancelTimer( handle );
+}
+
+/**
+ * @brief Executes callbacks of waiting tasks and removes them from the queue.
+ * All waiting tasks are taken from the queue at once. Tasks added meanwhile are executed in the next call.
+ * High and normal priority tasks are always executed. Low priority tasks are executed only until the frame
+ * task budget is exceeded and the remaining ones are deferred to the next call.
+ * This function MUST be called only from main thread.
+ */
+void TaskSystem::ExecuteWaitingTasks()
+{
+	m_impl->ExecuteWaitingTasks();
 }
 
+/**
+ * @brief Registers task system console variables and commands.
+ * This function MUST be called only from main thread after the engine console is created.
+ */
+void TaskSystem::RegisterConsoleCommands()
+{
+	m_impl->RegisterConsoleCommands();
+}
@@ -5,7 +5,8 @@
 
 #pragma once
 
-struct ILauncherTask;
+// Launcher headers
+#include "ILauncherTask.h"
 
 class TaskSystem
 {
@@ -16,8 +17,13 @@ public:
 	TaskSystem();
 	~TaskSystem();
 
-	void AddTask( ILauncherTask *pTask );
+	void AddTask( ILauncherTask *pTask, ELauncherTaskPriority priority = eLTP_Normal );
+
+	unsigned int AddTimer( ILauncherTask *pTask, unsigned int delay, unsigned int interval );
+	bool CancelTimer( unsigned int handle );
 
 	void ExecuteWaitingTasks();
+
+	void RegisterConsoleCommands();
 };
 
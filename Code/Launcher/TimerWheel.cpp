@@ -0,0 +1,366 @@
+/**
+ * @file
+ * @brief Implementation of hierarchical timer wheel for delayed and periodic launcher tasks.
+ *
+ * The root level has one bucket per tick. Each bucket of an upper level covers the whole range of the level below it.
+ * Timers that expire beyond the range of the highest level are placed at its end and re-inserted when they get there.
+ * Timers are stored in a vector and linked using indices, so adding or cancelling a timer doesn't allocate memory
+ * unless the vector grows. A handle consists of the timer index and its generation, so stale handles are rejected.
+ */
+
+#include <stddef.h>
+
+// Launcher headers
+#include "TimerWheel.h"
+
+#define TIMER_WHEEL_MAX_TIMERS 0xFFFF
+#define TIMER_WHEEL_MAX_DELTA ((1ULL << (TIMER_WHEEL_ROOT_BITS + (TIMER_WHEEL_LEVEL_COUNT - 1) * TIMER_WHEEL_LEVEL_BITS)) - 1)
+
+static unsigned int MakeHandle( int index, unsigned int generation )
+{
+	return ((generation & 0xFFFF) << 16) | (index + 1);
+}
+
+static int GetRootSlot( unsigned long long tick )
+{
+	return static_cast<int>( tick & (TIMER_WHEEL_ROOT_SIZE - 1) );
+}
+
+/**
+ * @param level Upper level starting from 1.
+ */
+static int GetLevelSlot( unsigned long long tick, int level )
+{
+	const int shift = TIMER_WHEEL_ROOT_BITS + (level - 1) * TIMER_WHEEL_LEVEL_BITS;
+	const int index = static_cast<int>( (tick >> shift) & (TIMER_WHEEL_LEVEL_SIZE - 1) );
+
+	return TIMER_WHEEL_ROOT_SIZE + (level - 1) * TIMER_WHEEL_LEVEL_SIZE + index;
+}
+
+TimerWheel::TimerWheel()
+: m_timers(),
+  m_freeTimer(-1),
+  m_runningTimer(-1),
+  m_currentTick(0),
+  m_activeCount(0),
+  m_executedCount(0),
+  m_cascadedCount(0)
+{
+	for ( int i = 0; i < TIMER_WHEEL_SLOT_COUNT; i++ )
+	{
+		m_slots[i] = -1;
+	}
+}
+
+int TimerWheel::AllocTimer()
+{
+	int index = m_freeTimer;
+
+	if ( index >= 0 )
+	{
+		m_freeTimer = m_timers[index].next;
+	}
+	else
+	{
+		if ( m_timers.size() >= TIMER_WHEEL_MAX_TIMERS )
+		{
+			return -1;
+		}
+
+		Timer timer;
+		timer.generation = 1;
+
+		index = static_cast<int>( m_timers.size() );
+		m_timers.push_back( timer );
+	}
+
+	Timer & timer = m_timers[index];
+	timer.pTask = NULL;
+	timer.expireTick = 0;
+	timer.interval = 0;
+	timer.prev = -1;
+	timer.next = -1;
+	timer.slot = -1;
+	timer.isCancelled = false;
+
+	return index;
+}
+
+void TimerWheel::FreeTimer( int index )
+{
+	Timer & timer = m_timers[index];
+
+	// invalidate all handles of this timer
+	timer.generation++;
+	timer.pTask = NULL;
+	timer.next = m_freeTimer;
+
+	m_freeTimer = index;
+	m_activeCount--;
+}
+
+void TimerWheel::Link( int index )
+{
+	Timer & timer = m_timers[index];
+
+	// the bucket of the current tick is detached while its tasks are running, so they add timers to the next tick
+	const unsigned long long minTick = (m_runningTimer >= 0) ? m_currentTick + 1 : m_currentTick;
+	const unsigned long long expireTick = (timer.expireTick > minTick) ? timer.expireTick : minTick;
+	unsigned long long delta = expireTick - m_currentTick;
+
+	// the timer is re-inserted once it gets to the end of the highest level
+	const unsigned long long slotTick = (delta > TIMER_WHEEL_MAX_DELTA) ? m_currentTick + TIMER_WHEEL_MAX_DELTA : expireTick;
+	delta = slotTick - m_currentTick;
+
+	int slot;
+
+	if ( delta < TIMER_WHEEL_ROOT_SIZE )
+	{
+		slot = GetRootSlot( slotTick );
+	}
+	else
+	{
+		int level = 1;
+		unsigned long long range = TIMER_WHEEL_ROOT_SIZE * TIMER_WHEEL_LEVEL_SIZE;
+
+		while ( delta >= range && level < TIMER_WHEEL_LEVEL_COUNT - 1 )
+		{
+			range <<= TIMER_WHEEL_LEVEL_BITS;
+			level++;
+		}
+
+		slot = GetLevelSlot( slotTick, level );
+	}
+
+	timer.slot = slot;
+	timer.prev = -1;
+	timer.next = m_slots[slot];
+
+	if ( timer.next >= 0 )
+	{
+		m_timers[timer.next].prev = index;
+	}
+
+	m_slots[slot] = index;
+}
+
+void TimerWheel::Unlink( int index )
+{
+	Timer & timer = m_timers[index];
+
+	if ( timer.prev >= 0 )
+	{
+		m_timers[timer.prev].next = timer.next;
+	}
+	else
+	{
+		m_slots[timer.slot] = timer.next;
+	}
+
+	if ( timer.next >= 0 )
+	{
+		m_timers[timer.next].prev = timer.prev;
+	}
+
+	timer.prev = -1;
+	timer.next = -1;
+	timer.slot = -1;
+}
+
+/**
+ * @brief Redistributes timers from the current bucket of an upper level to lower levels.
+ * @return Index of the bucket within its level.
+ */
+int TimerWheel::Cascade( int level )
+{
+	const int slot = GetLevelSlot( m_currentTick, level );
+
+	int index = m_slots[slot];
+	m_slots[slot] = -1;
+
+	while ( index >= 0 )
+	{
+		const int next = m_timers[index].next;
+
+		Link( index );
+		m_cascadedCount++;
+
+		index = next;
+	}
+
+	return slot - TIMER_WHEEL_ROOT_SIZE - (level - 1) * TIMER_WHEEL_LEVEL_SIZE;
+}
+
+void TimerWheel::ExpireSlot( int slot )
+{
+	// take the whole bucket, timers added by the executed tasks never expire in the current tick
+	int index = m_slots[slot];
+	m_slots[slot] = -1;
+
+	// detached timers keep only their next links, so cancelling them must not touch the list
+	for ( int i = index; i >= 0; i = m_timers[i].next )
+	{
+		m_timers[i].prev = -1;
+		m_timers[i].slot = -1;
+	}
+
+	while ( index >= 0 )
+	{
+		const int next = m_timers[index].next;
+
+		m_timers[index].next = -1;
+
+		if ( m_timers[index].isCancelled )
+		{
+			// cancelled by one of the previous tasks
+			delete m_timers[index].pTask;
+			FreeTimer( index );
+			index = next;
+			continue;
+		}
+
+		if ( m_timers[index].expireTick > m_currentTick )
+		{
+			// beyond the range of the wheel
+			Link( index );
+			index = next;
+			continue;
+		}
+
+		// the task may add or cancel timers, so no references are kept
+		m_runningTimer = index;
+		m_timers[index].pTask->Run();
+		m_runningTimer = -1;
+
+		m_executedCount++;
+
+		Timer & timer = m_timers[index];
+
+		if ( timer.interval > 0 && ! timer.isCancelled )
+		{
+			// missed periods are skipped
+			timer.expireTick += timer.interval;
+			if ( timer.expireTick <= m_currentTick )
+			{
+				timer.expireTick = m_currentTick + 1;
+			}
+
+			Link( index );
+		}
+		else
+		{
+			delete timer.pTask;
+			FreeTimer( index );
+		}
+
+		index = next;
+	}
+}
+
+/**
+ * @brief Sets the current tick.
+ * Must be called before any timers are added.
+ */
+void TimerWheel::Init( unsigned long long currentTick )
+{
+	m_currentTick = currentTick;
+}
+
+/**
+ * @brief Adds new timer.
+ * @param pTask The task allocated on heap using the "new" operator. It's destroyed when the timer is removed.
+ * @param delay Number of ticks until the first execution. Zero means the next tick.
+ * @param interval Number of ticks between executions of periodic task or 0 to execute the task only once.
+ * @return Handle of the timer or 0 if there are too many timers.
+ */
+unsigned int TimerWheel::Add( ILauncherTask *pTask, unsigned int delay, unsigned int interval )
+{
+	const int index = AllocTimer();
+	if ( index < 0 )
+	{
+		return 0;
+	}
+
+	Timer & timer = m_timers[index];
+	timer.pTask = pTask;
+	timer.expireTick = m_currentTick + delay;
+	timer.interval = interval;
+
+	Link( index );
+
+	m_activeCount++;
+
+	return MakeHandle( index, timer.generation );
+}
+
+/**
+ * @brief Removes timer and destroys its task.
+ * A periodic task can cancel itself. It's destroyed once it returns.
+ * @param handle Handle of the timer.
+ * @return True if the timer was removed, otherwise false if the handle is not valid or the task already expired.
+ */
+bool TimerWheel::Cancel( unsigned int handle )
+{
+	const int index = static_cast<int>( handle & 0xFFFF ) - 1;
+
+	if ( index < 0 || index >= static_cast<int>( m_timers.size() ) )
+	{
+		return false;
+	}
+
+	Timer & timer = m_timers[index];
+
+	if ( ! timer.pTask || timer.isCancelled || (timer.generation & 0xFFFF) != (handle >> 16) )
+	{
+		return false;
+	}
+
+	if ( timer.slot < 0 )
+	{
+		// the timer is running or waiting in the detached bucket, so it's destroyed there
+		timer.isCancelled = true;
+		return true;
+	}
+
+	Unlink( index );
+
+	delete timer.pTask;
+	FreeTimer( index );
+
+	return true;
+}
+
+/**
+ * @brief Executes tasks of all timers that expire until the specified tick.
+ * Each tick costs constant work. Ticks without any timers are skipped at once.
+ * @param currentTick The current tick.
+ */
+void TimerWheel::Advance( unsigned long long currentTick )
+{
+	while ( m_currentTick < currentTick )
+	{
+		if ( m_activeCount == 0 )
+		{
+			m_currentTick = currentTick;
+			break;
+		}
+
+		const int rootSlot = GetRootSlot( m_currentTick );
+
+		// the root level finished its revolution
+		if ( rootSlot == 0 )
+		{
+			for ( int level = 1; level < TIMER_WHEEL_LEVEL_COUNT; level++ )
+			{
+				if ( Cascade( level ) != 0 )
+				{
+					break;
+				}
+			}
+		}
+
+		ExpireSlot( rootSlot );
+
+		m_currentTick++;
+	}
+}
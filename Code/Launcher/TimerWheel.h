@@ -0,0 +1,89 @@
+/**
+ * @file
+ * @brief Hierarchical timer wheel for delayed and periodic launcher tasks.
+ */
+
+#pragma once
+
+#include <vector>
+
+// Launcher headers
+#include "ILauncherTask.h"
+
+#define TIMER_WHEEL_ROOT_BITS 8
+#define TIMER_WHEEL_LEVEL_BITS 6
+#define TIMER_WHEEL_LEVEL_COUNT 4  // root level and 3 upper levels
+
+#define TIMER_WHEEL_ROOT_SIZE (1 << TIMER_WHEEL_ROOT_BITS)
+#define TIMER_WHEEL_LEVEL_SIZE (1 << TIMER_WHEEL_LEVEL_BITS)
+#define TIMER_WHEEL_SLOT_COUNT (TIMER_WHEEL_ROOT_SIZE + (TIMER_WHEEL_LEVEL_COUNT - 1) * TIMER_WHEEL_LEVEL_SIZE)
+
+/**
+ * @brief Schedules launcher tasks to be executed after some number of ticks.
+ * Timers are kept in buckets of several levels with increasing resolution. Each tick takes one bucket of the root
+ * level and buckets of upper levels are redistributed to lower levels only once per revolution of the lower level.
+ * All functions must be called only from main thread.
+ */
+class TimerWheel
+{
+	struct Timer
+	{
+		ILauncherTask *pTask;
+		unsigned long long expireTick;
+		unsigned int interval;
+		unsigned int generation;
+		int prev;
+		int next;
+		int slot;  //!< Index of the bucket or -1 if the bucket of the timer is being expired.
+		bool isCancelled;
+	};
+
+	std::vector<Timer> m_timers;
+	int m_freeTimer;
+	int m_runningTimer;
+	int m_slots[TIMER_WHEEL_SLOT_COUNT];
+
+	unsigned long long m_currentTick;
+	unsigned int m_activeCount;
+
+	unsigned int m_executedCount;
+	unsigned int m_cascadedCount;
+
+	int AllocTimer();
+	void FreeTimer( int index );
+
+	void Link( int index );
+	void Unlink( int index );
+
+	int Cascade( int level );
+	void ExpireSlot( int slot );
+
+	// disable implicit copy constructor and copy assignment operator
+	TimerWheel( const TimerWheel & );
+	TimerWheel & operator=( const TimerWheel & );
+
+public:
+	TimerWheel();
+
+	void Init( unsigned long long currentTick );
+
+	unsigned int Add( ILauncherTask *pTask, unsigned int delay, unsigned int interval );
+	bool Cancel( unsigned int handle );
+
+	void Advance( unsigned long long currentTick );
+
+	unsigned int GetActiveCount() const
+	{
+		return m_activeCount;
+	}
+
+	unsigned int GetExecutedCount() const
+	{
+		return m_executedCount;
+	}
+
+	unsigned int GetCascadedCount() const
+	{
+		return m_cascadedCount;
+	}
+};
@@ -0,0 +1,437 @@
+/**
+ * @file
+ * @brief Implementation of launcher worker thread pool.
+ *
+ * Each worker has its own job queue. Jobs added by a worker go to its own queue and the worker takes them in LIFO
+ * order, so related work stays on the same thread. Jobs added by other threads are distributed in round-robin order.
+ * Idle workers steal the oldest jobs from queues of other workers. A single semaphore counts all queued jobs, so each
+ * worker that passes the semaphore is guaranteed to find a job in some queue.
+ */
+
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#include <string.h>
+#include <deque>
+#include <vector>
+
+// CryEngine headers
+#include "ISystem.h"
+#include "IConsole.h"
+
+// Launcher headers
+#include "WorkerPool.h"
+#include "LauncherEnv.h"
+#include "TaskSystem.h"
+
+class WorkerPool::Impl
+{
+	struct Worker
+	{
+		Impl *pPool;
+		unsigned int index;
+		HANDLE hThread;
+		CRITICAL_SECTION lock;
+		std::deque<ILauncherJob*> jobs;
+
+		volatile LONG executedCount;
+		volatile LONG stolenCount;
+	};
+
+	std::vector<Worker*> m_workers;
+	HANDLE m_hSemaphore;
+	DWORD m_tlsIndex;
+
+	volatile LONG m_isStopping;
+	volatile LONG m_nextWorker;
+	volatile LONG m_queuedCount;
+
+	static DWORD WINAPI ThreadRoutine( LPVOID param );
+
+	static ILauncherJob *PopOwnJob( Worker *pWorker );
+	ILauncherJob *StealJob( Worker *pThief );
+
+	void PushJob( Worker *pWorker, ILauncherJob *pJob );
+	void ExecuteJob( Worker *pWorker, ILauncherJob *pJob );
+
+	unsigned int DestroyQueuedJobs();
+
+	static void OnWorkerStatsCmd( IConsoleCmdArgs *pArgs );
+
+public:
+	Impl()
+	: m_workers(),
+	  m_hSemaphore(NULL),
+	  m_tlsIndex(TLS_OUT_OF_INDEXES),
+	  m_isStopping(0),
+	  m_nextWorker(0),
+	  m_queuedCount(0)
+	{
+	}
+
+	~Impl()
+	{
+		Stop();
+	}
+
+	bool IsRunning() const
+	{
+		return ! m_workers.empty();
+	}
+
+	unsigned int GetThreadCount() const
+	{
+		return static_cast<unsigned int>( m_workers.size() );
+	}
+
+	bool Start( unsigned int threadCount );
+	void Stop();
+
+	bool AddJob( ILauncherJob *pJob );
+
+	void RegisterConsoleCommands();
+};
+
+DWORD WINAPI WorkerPool::Impl::ThreadRoutine( LPVOID param )  // static function
+{
+	Worker *pWorker = static_cast<Worker*>( param );
+	Impl *self = pWorker->pPool;
+
+	TlsSetValue( self->m_tlsIndex, pWorker );
+
+	for (;;)
+	{
+		WaitForSingleObject( self->m_hSemaphore, INFINITE );
+
+		if ( self->m_isStopping )
+		{
+			break;
+		}
+
+		ILauncherJob *pJob = PopOwnJob( pWorker );
+
+		// the semaphore guarantees that some queue contains a job, but other workers may be scanning the queues too
+		while ( ! pJob )
+		{
+			pJob = self->StealJob( pWorker );
+		}
+
+		self->ExecuteJob( pWorker, pJob );
+	}
+
+	return 0;
+}
+
+ILauncherJob *WorkerPool::Impl::PopOwnJob( Worker *pWorker )  // static function
+{
+	ILauncherJob *pJob = NULL;
+
+	EnterCriticalSection( &pWorker->lock );
+
+	if ( ! pWorker->jobs.empty() )
+	{
+		// the newest job first
+		pJob = pWorker->jobs.back();
+		pWorker->jobs.pop_back();
+	}
+
+	LeaveCriticalSection( &pWorker->lock );
+
+	return pJob;
+}
+
+ILauncherJob *WorkerPool::Impl::StealJob( Worker *pThief )
+{
+	const size_t workerCount = m_workers.size();
+
+	for ( size_t i = 1; i <= workerCount; i++ )
+	{
+		Worker *pVictim = m_workers[(pThief->index + i) % workerCount];
+
+		ILauncherJob *pJob = NULL;
+
+		EnterCriticalSection( &pVictim->lock );
+
+		if ( ! pVictim->jobs.empty() )
+		{
+			// the oldest job first
+			pJob = pVictim->jobs.front();
+			pVictim->jobs.pop_front();
+		}
+
+		LeaveCriticalSection( &pVictim->lock );
+
+		if ( pJob )
+		{
+			if ( pVictim != pThief )
+			{
+				InterlockedIncrement( &pThief->stolenCount );
+			}
+
+			return pJob;
+		}
+	}
+
+	// let other workers finish taking their jobs
+	SwitchToThread();
+
+	return NULL;
+}
+
+void WorkerPool::Impl::PushJob( Worker *pWorker, ILauncherJob *pJob )
+{
+	EnterCriticalSection( &pWorker->lock );
+	pWorker->jobs.push_back( pJob );
+	LeaveCriticalSection( &pWorker->lock );
+
+	InterlockedIncrement( &m_queuedCount );
+
+	ReleaseSemaphore( m_hSemaphore, 1, NULL );
+}
+
+void WorkerPool::Impl::ExecuteJob( Worker *pWorker, ILauncherJob *pJob )
+{
+	InterlockedDecrement( &m_queuedCount );
+
+	pJob->Execute();
+
+	InterlockedIncrement( &pWorker->executedCount );
+
+	// hand the job over to main thread, the task system destroys it
+	gLauncher->pTaskSystem->AddTask( pJob );
+}
+
+unsigned int WorkerPool::Impl::DestroyQueuedJobs()
+{
+	unsigned int count = 0;
+
+	for ( size_t i = 0; i < m_workers.size(); i++ )
+	{
+		std::deque<ILauncherJob*> & jobs = m_workers[i]->jobs;
+
+		for ( size_t j = 0; j < jobs.size(); j++ )
+		{
+			delete jobs[j];
+			count++;
+		}
+
+		jobs.clear();
+	}
+
+	m_queuedCount = 0;
+
+	return count;
+}
+
+bool WorkerPool::Impl::Start( unsigned int threadCount )
+{
+	if ( IsRunning() || threadCount == 0 )
+	{
+		return false;
+	}
+
+	m_tlsIndex = TlsAlloc();
+	if ( m_tlsIndex == TLS_OUT_OF_INDEXES )
+	{
+		return false;
+	}
+
+	m_hSemaphore = CreateSemaphoreA( NULL, 0, 0x7FFFFFFF, NULL );
+	if ( ! m_hSemaphore )
+	{
+		TlsFree( m_tlsIndex );
+		m_tlsIndex = TLS_OUT_OF_INDEXES;
+		return false;
+	}
+
+	m_isStopping = 0;
+
+	for ( unsigned int i = 0; i < threadCount; i++ )
+	{
+		Worker *pWorker = new Worker();
+		pWorker->pPool = this;
+		pWorker->index = i;
+		pWorker->hThread = NULL;
+		pWorker->executedCount = 0;
+		pWorker->stolenCount = 0;
+
+		InitializeCriticalSection( &pWorker->lock );
+
+		m_workers.push_back( pWorker );
+	}
+
+	// threads are created after all workers exist because they steal from each other
+	for ( size_t i = 0; i < m_workers.size(); i++ )
+	{
+		Worker *pWorker = m_workers[i];
+
+		pWorker->hThread = CreateThread( NULL, 0, ThreadRoutine, pWorker, 0, NULL );
+		if ( ! pWorker->hThread )
+		{
+			Stop();
+			return false;
+		}
+	}
+
+	return true;
+}
+
+void WorkerPool::Impl::Stop()
+{
+	if ( ! IsRunning() )
+	{
+		return;
+	}
+
+	InterlockedExchange( &m_isStopping, 1 );
+
+	// wake up all workers, running jobs are finished
+	ReleaseSemaphore( m_hSemaphore, static_cast<LONG>( m_workers.size() ), NULL );
+
+	for ( size_t i = 0; i < m_workers.size(); i++ )
+	{
+		HANDLE hThread = m_workers[i]->hThread;
+
+		if ( hThread )
+		{
+			WaitForSingleObject( hThread, INFINITE );
+			CloseHandle( hThread );
+		}
+	}
+
+	// jobs that were not started yet are never executed
+	DestroyQueuedJobs();
+
+	for ( size_t i = 0; i < m_workers.size(); i++ )
+	{
+		DeleteCriticalSection( &m_workers[i]->lock );
+		delete m_workers[i];
+	}
+
+	m_workers.clear();
+
+	CloseHandle( m_hSemaphore );
+	m_hSemaphore = NULL;
+
+	TlsFree( m_tlsIndex );
+	m_tlsIndex = TLS_OUT_OF_INDEXES;
+}
+
+bool WorkerPool::Impl::AddJob( ILauncherJob *pJob )
+{
+	if ( ! IsRunning() || m_isStopping )
+	{
+		return false;
+	}
+
+	Worker *pWorker = static_cast<Worker*>( TlsGetValue( m_tlsIndex ) );
+
+	if ( ! pWorker )
+	{
+		// job from another thread
+		const LONG index = InterlockedIncrement( &m_nextWorker );
+
+		pWorker = m_workers[static_cast<unsigned long>( index ) % m_workers.size()];
+	}
+
+	PushJob( pWorker, pJob );
+
+	return true;
+}
+
+void WorkerPool::Impl::OnWorkerStatsCmd( IConsoleCmdArgs *pArgs )  // static function
+{
+	Impl *self = gLauncher->pWorkerPool->m_impl;
+
+	CryLogAlways( "$3Launcher workers: threads = %u | queued = %ld", self->GetThreadCount(), self->m_queuedCount );
+
+	for ( size_t i = 0; i < self->m_workers.size(); i++ )
+	{
+		Worker *pWorker = self->m_workers[i];
+
+		CryLogAlways( "Worker %-2u | executed = %ld | stolen = %ld",
+		  pWorker->index, pWorker->executedCount, pWorker->stolenCount );
+	}
+}
+
+void WorkerPool::Impl::RegisterConsoleCommands()
+{
+	IConsole *pConsole = gLauncher->pSystem->GetIConsole();
+
+	pConsole->AddCommand( "launcher_workerstats", OnWorkerStatsCmd, 0,
+	  "Shows launcher worker threads and their job counters.\n"
+	  "Usage: launcher_workerstats"
+	);
+}
+
+/**
+ * @brief Constructor.
+ */
+WorkerPool::WorkerPool()
+: m_impl(new Impl())
+{
+}
+
+/**
+ * @brief Destructor.
+ * Stops the worker threads if they are still running.
+ */
+WorkerPool::~WorkerPool()
+{
+	delete m_impl;
+}
+
+/**
+ * @brief Starts the worker threads.
+ * This function MUST be called only from main thread.
+ * @param threadCount Number of worker threads.
+ * @return True if all threads were started, otherwise false.
+ */
+bool WorkerPool::Start( unsigned int threadCount )
+{
+	return m_impl->Start( threadCount );
+}
+
+/**
+ * @brief Stops the worker threads.
+ * Jobs that are being executed are finished. Queued jobs that were not started yet are destroyed without execution.
+ * This function MUST be called only from main thread while no other threads add new jobs.
+ */
+void WorkerPool::Stop()
+{
+	m_impl->Stop();
+}
+
+bool WorkerPool::IsRunning() const
+{
+	return m_impl->IsRunning();
+}
+
+unsigned int WorkerPool::GetThreadCount() const
+{
+	return m_impl->GetThreadCount();
+}
+
+/**
+ * @brief Adds job to be executed by a worker thread.
+ * This function can be called from any thread.
+ * @param pJob The job allocated on heap using the "new" operator.
+ * @return True if the job was added, otherwise false and the caller still owns the job.
+ */
+bool WorkerPool::AddJob( ILauncherJob *pJob )
+{
+	if ( ! pJob )
+	{
+		return false;
+	}
+
+	return m_impl->AddJob( pJob );
+}
+
+/**
+ * @brief Registers worker pool console commands.
+ * This function MUST be called only from main thread after the engine console is created.
+ */
+void WorkerPool::RegisterConsoleCommands()
+{
+	m_impl->RegisterConsoleCommands();
+}
@@ -0,0 +1,33 @@
+/**
+ * @file
+ * @brief Launcher worker thread pool.
+ */
+
+#pragma once
+
+// Launcher headers
+#include "ILauncherTask.h"
+
+class WorkerPool
+{
+	class Impl;
+	Impl *m_impl;  // std::unique_ptr is C++11
+
+	// disable implicit copy constructor and copy assignment operator
+	WorkerPool( const WorkerPool & );
+	WorkerPool & operator=( const WorkerPool & );
+
+public:
+	WorkerPool();
+	~WorkerPool();
+
+	bool Start( unsigned int threadCount );
+	void Stop();
+
+	bool IsRunning() const;
+	unsigned int GetThreadCount() const;
+
+	bool AddJob( ILauncherJob *pJob );
+
+	void RegisterConsoleCommands();
+};
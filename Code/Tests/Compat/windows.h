@@ -0,0 +1,156 @@
+/**
+ * @file
+ * @brief Minimal subset of Windows API for building launcher components and tests on other platforms.
+ * Only what the tested components and the tests use is provided. It's never used in the launcher itself.
+ */
+
+#pragma once
+
+#ifdef _WIN32
+#error "Use the real windows.h"
+#endif
+
+#include <pthread.h>
+#include <sched.h>
+#include <stdlib.h>
+#include <time.h>
+
+typedef void *PVOID;
+typedef void *HANDLE;
+typedef unsigned long DWORD;
+typedef int BOOL;
+
+#define WINAPI
+#define INFINITE 0xFFFFFFFF
+#define WAIT_OBJECT_0 0
+
+// --- Interlocked functions ---
+
+inline PVOID InterlockedCompareExchangePointer( PVOID volatile *destination, PVOID exchange, PVOID comparand )
+{
+	return __sync_val_compare_and_swap( destination, comparand, exchange );
+}
+
+inline PVOID InterlockedExchangePointer( PVOID volatile *target, PVOID value )
+{
+	return __atomic_exchange_n( target, value, __ATOMIC_SEQ_CST );
+}
+
+inline long InterlockedIncrement( long volatile *addend )
+{
+	return __sync_add_and_fetch( addend, 1 );
+}
+
+// --- Critical section ---
+
+typedef pthread_mutex_t CRITICAL_SECTION;
+
+inline void InitializeCriticalSection( CRITICAL_SECTION *cs )
+{
+	pthread_mutex_init( cs, NULL );
+}
+
+inline void DeleteCriticalSection( CRITICAL_SECTION *cs )
+{
+	pthread_mutex_destroy( cs );
+}
+
+inline void EnterCriticalSection( CRITICAL_SECTION *cs )
+{
+	pthread_mutex_lock( cs );
+}
+
+inline void LeaveCriticalSection( CRITICAL_SECTION *cs )
+{
+	pthread_mutex_unlock( cs );
+}
+
+// --- Threads ---
+
+typedef DWORD (WINAPI *LPTHREAD_START_ROUTINE)( void *param );
+
+struct CompatThread
+{
+	pthread_t thread;
+	LPTHREAD_START_ROUTINE routine;
+	void *param;
+};
+
+inline void *CompatThreadRoutine( void *param )
+{
+	CompatThread *pThread = static_cast<CompatThread*>( param );
+	pThread->routine( pThread->param );
+
+	return NULL;
+}
+
+inline HANDLE CreateThread( void *, size_t, LPTHREAD_START_ROUTINE routine, void *param, DWORD, DWORD * )
+{
+	CompatThread *pThread = new CompatThread;
+	pThread->routine = routine;
+	pThread->param = param;
+
+	if ( pthread_create( &pThread->thread, NULL, CompatThreadRoutine, pThread ) != 0 )
+	{
+		delete pThread;
+		return NULL;
+	}
+
+	return pThread;
+}
+
+/**
+ * @brief Only waiting for a thread to finish is supported.
+ */
+inline DWORD WaitForSingleObject( HANDLE hThread, DWORD )
+{
+	pthread_join( static_cast<CompatThread*>( hThread )->thread, NULL );
+
+	return WAIT_OBJECT_0;
+}
+
+inline BOOL CloseHandle( HANDLE hThread )
+{
+	delete static_cast<CompatThread*>( hThread );
+
+	return 1;
+}
+
+inline void Sleep( DWORD milliseconds )
+{
+	if ( milliseconds == 0 )
+	{
+		sched_yield();
+		return;
+	}
+
+	timespec duration;
+	duration.tv_sec = milliseconds / 1000;
+	duration.tv_nsec = (milliseconds % 1000) * 1000000L;
+
+	nanosleep( &duration, NULL );
+}
+
+// --- Time ---
+
+typedef union _LARGE_INTEGER
+{
+	long long QuadPart;
+} LARGE_INTEGER;
+
+inline BOOL QueryPerformanceFrequency( LARGE_INTEGER *frequency )
+{
+	frequency->QuadPart = 1000000000LL;
+
+	return 1;
+}
+
+inline BOOL QueryPerformanceCounter( LARGE_INTEGER *counter )
+{
+	timespec now;
+	clock_gettime( CLOCK_MONOTONIC, &now );
+
+	counter->QuadPart = now.tv_sec * 1000000000LL + now.tv_nsec;
+
+	return 1;
+}
@@ -0,0 +1,76 @@
+/**
+ * @file
+ * @brief Benchmark of FastFormat against snprintf_ with the formats used by the log.
+ */
+
+#include <stdio.h>
+#include <time.h>
+
+// Library headers
+#include "printf/printf.h"
+
+// Launcher headers
+#include "FastFormat.h"
+
+#include "Test.h"
+
+#define BENCHMARK_ITERATIONS 5000000
+
+extern "C" void _putchar( char c )  // required by the printf library
+{
+	putchar( c );
+}
+
+static volatile size_t g_sink;
+
+static double GetSeconds( clock_t start )
+{
+	return static_cast<double>( clock() - start ) / CLOCKS_PER_SEC;
+}
+
+static void Report( const char *name, double fastTime, double printfTime )
+{
+	printf( "%-6s | FastFormat = %.3f s | snprintf_ = %.3f s | ratio = %.2f\n",
+	  name, fastTime, printfTime, (fastTime > 0) ? printfTime / fastTime : 0 );
+}
+
+int main()
+{
+	char buffer[64];
+	TestRandom random( 3 );
+
+	// %7.3f is the relative time prefix of each log line
+	clock_t start = clock();
+	for ( int i = 0; i < BENCHMARK_ITERATIONS; i++ )
+	{
+		g_sink += FastFormat::FormatFixed( buffer, random.Next( 100000000 ) / 1000.0, 3, 7 );
+	}
+	const double fastFixed = GetSeconds( start );
+
+	start = clock();
+	for ( int i = 0; i < BENCHMARK_ITERATIONS; i++ )
+	{
+		g_sink += snprintf_( buffer, sizeof buffer, "%7.3f", random.Next( 100000000 ) / 1000.0 );
+	}
+	const double printfFixed = GetSeconds( start );
+
+	// %lu is used for thread IDs and counters
+	start = clock();
+	for ( int i = 0; i < BENCHMARK_ITERATIONS; i++ )
+	{
+		g_sink += FastFormat::FormatUInt( buffer, random.Next(), 0, ' ' );
+	}
+	const double fastUInt = GetSeconds( start );
+
+	start = clock();
+	for ( int i = 0; i < BENCHMARK_ITERATIONS; i++ )
+	{
+		g_sink += snprintf_( buffer, sizeof buffer, "%lu", static_cast<unsigned long>( random.Next() ) );
+	}
+	const double printfUInt = GetSeconds( start );
+
+	Report( "%7.3f", fastFixed, printfFixed );
+	Report( "%lu", fastUInt, printfUInt );
+
+	return 0;
+}
@@ -0,0 +1,163 @@
+/**
+ * @file
+ * @brief Equivalence and round-trip test of FastFormat against snprintf_.
+ */
+
+#include <float.h>
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+
+// Library headers
+#include "printf/printf.h"
+
+// Launcher headers
+#include "FastFormat.h"
+
+#include "Test.h"
+
+int g_testFailCount = 0;
+
+extern "C" void _putchar( char c )  // required by the printf library
+{
+	putchar( c );
+}
+
+static const double POW10[] = { 1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000, 1000000000 };
+
+static unsigned long long RandomUInt64( TestRandom & random )
+{
+	const unsigned long long value = (static_cast<unsigned long long>( random.Next() ) << 32) | random.Next();
+
+	// all lengths are equally likely
+	return value >> random.Next( 64 );
+}
+
+static double RandomDouble( TestRandom & random )
+{
+	const unsigned int kind = random.Next( 4 );
+
+	if ( kind == 0 )
+	{
+		// halfway cases and rollovers like 0.95, 9.9995 or 0.5
+		const unsigned int precision = random.Next( FastFormat::MAX_PRECISION + 1 );
+		const double whole = random.Next( 1000 );
+		const double frac = (POW10[precision] - 1 - random.Next( 3 ) + 0.5) / POW10[precision];
+
+		return (random.Next( 2 ) ? -1 : 1) * (whole + frac);
+	}
+
+	// random mantissa and magnitude up to the limit of the fast path
+	const double mantissa = static_cast<double>( random.Next() ) / 0xFFFFFFFFu;
+	const double value = mantissa * POW10[random.Next( 10 )];
+
+	return (random.Next( 2 ) ? -1 : 1) * ((kind == 1) ? floor( value * 1000 ) / 1000 : value);
+}
+
+static std::string FormatFixed( double value, unsigned int precision, unsigned int width )
+{
+	char buffer[FastFormat::MAX_FIXED_LENGTH + 1];
+	const size_t length = FastFormat::FormatFixed( buffer, value, precision, width );
+
+	return std::string( buffer, length );
+}
+
+/**
+ * @brief Checks if vsnprintf_ rounds the value to the next whole number incorrectly.
+ * Exact halfway cases with all nines, e.g. 0.95 with precision 1, are printed as "0.10" instead of "1.0".
+ */
+static bool IsKnownRolloverBug( double value, unsigned int precision )
+{
+	value = fabs( value );
+
+	const int whole = static_cast<int>( value );
+	const double tmp = (value - whole) * POW10[precision];
+	const unsigned long frac = static_cast<unsigned long>( tmp );
+
+	return precision > 0 && tmp - frac == 0.5 && frac + 1 >= POW10[precision];
+}
+
+static void CheckInt()
+{
+	static const unsigned long long VALUES[] = {
+		0, 1, 9, 10, 99, 100, 4294967295ULL, 4294967296ULL, 18446744073709551615ULL, 9223372036854775808ULL,
+	};
+
+	TestRandom random( 1 );
+
+	for ( int i = 0; i < 1000000; i++ )
+	{
+		const unsigned long long value = (i < 10) ? VALUES[i] : RandomUInt64( random );
+		const unsigned int width = random.Next( 25 );
+		const char pad = random.Next( 2 ) ? '0' : ' ';
+
+		char expected[64];
+		char result[64];
+
+		// unsigned
+		snprintf_( expected, sizeof expected, (pad == '0') ? "%0*llu" : "%*llu", width, value );
+		size_t length = FastFormat::FormatUInt( result, value, width, pad );
+
+		TEST_CHECK( std::string( result, length ) == expected, "FormatUInt( %s, %u, '%c' ) = \"%.*s\"",
+		  expected, width, pad, static_cast<int>( length ), result );
+
+		// signed
+		const long long signedValue = static_cast<long long>( value ) * (random.Next( 2 ) ? -1 : 1);
+
+		snprintf_( expected, sizeof expected, (pad == '0') ? "%0*lld" : "%*lld", width, signedValue );
+		length = FastFormat::FormatInt( result, signedValue, width, pad );
+
+		TEST_CHECK( std::string( result, length ) == expected, "FormatInt( %s, %u, '%c' ) = \"%.*s\"",
+		  expected, width, pad, static_cast<int>( length ), result );
+	}
+}
+
+static void CheckFixed()
+{
+	static const double VALUES[] = { 0, -0.0, 0.5, 1.5, 2.5, 0.05, 0.95, 999999999.5, 1e9, -1e9, 1e10, -1e300 };
+
+	TestRandom random( 2 );
+
+	for ( int i = 0; i < 2000000; i++ )
+	{
+		const double value = (i < 12) ? VALUES[i] : RandomDouble( random );
+		const unsigned int precision = random.Next( FastFormat::MAX_PRECISION + 1 );
+		const unsigned int width = random.Next( 16 );
+
+		const std::string result = FormatFixed( value, precision, width );
+
+		char expected[64];
+
+		if ( IsKnownRolloverBug( value, precision ) )
+		{
+			const double rounded = (value < 0) ? -ceil( -value ) : ceil( value );
+			snprintf_( expected, sizeof expected, "%*.*f", width, precision, rounded );
+		}
+		else
+		{
+			snprintf_( expected, sizeof expected, "%*.*f", width, precision, value );
+		}
+
+		TEST_CHECK( result == expected, "FormatFixed( %.17g, %u, %u ) = \"%s\", expected \"%s\"",
+		  value, precision, width, result.c_str(), expected );
+
+		if ( fabs( value ) <= 1e9 )
+		{
+			// the printed value must be the nearest one with the precision
+			const double parsed = strtod( result.c_str(), NULL );
+			const double maxError = 0.5 / POW10[precision] + 4 * DBL_EPSILON * fabs( value );
+
+			TEST_CHECK( fabs( parsed - value ) <= maxError, "FormatFixed( %.17g, %u, %u ) = \"%s\" doesn't round-trip",
+			  value, precision, width, result.c_str() );
+		}
+	}
+}
+
+int main()
+{
+	CheckInt();
+	CheckFixed();
+
+	TEST_MAIN_END();
+}
@@ -0,0 +1,132 @@
+/**
+ * @file
+ * @brief Stress test of LockFreeQueue with concurrent producers.
+ */
+
+#include <vector>
+
+// Launcher headers
+#include "LockFreeQueue.h"
+
+#include "Test.h"
+
+#define TEST_PRODUCER_COUNT 8
+#define TEST_NODES_PER_PRODUCER 200000
+
+int g_testFailCount = 0;
+
+struct TestNode : public LockFreeQueueNode
+{
+	int producer;
+	int seq;
+};
+
+struct Producer
+{
+	LockFreeQueue *pQueue;
+	std::vector<TestNode> nodes;
+	volatile long *pStartFlag;
+
+	static DWORD WINAPI ThreadRoutine( void *param )
+	{
+		Producer *self = static_cast<Producer*>( param );
+
+		// all producers start at once to maximize contention
+		while ( ! *self->pStartFlag )
+		{
+		}
+
+		for ( size_t i = 0; i < self->nodes.size(); i++ )
+		{
+			self->pQueue->Push( &self->nodes[i] );
+
+			// interleave the threads even on a single core
+			if ( (i % 1024) == 0 )
+			{
+				Sleep( 0 );
+			}
+		}
+
+		return 0;
+	}
+};
+
+int main()
+{
+	LockFreeQueue queue;
+	volatile long startFlag = 0;
+
+	Producer producers[TEST_PRODUCER_COUNT];
+	HANDLE threads[TEST_PRODUCER_COUNT];
+
+	for ( int p = 0; p < TEST_PRODUCER_COUNT; p++ )
+	{
+		producers[p].pQueue = &queue;
+		producers[p].pStartFlag = &startFlag;
+		producers[p].nodes.resize( TEST_NODES_PER_PRODUCER );
+
+		for ( int i = 0; i < TEST_NODES_PER_PRODUCER; i++ )
+		{
+			producers[p].nodes[i].producer = p;
+			producers[p].nodes[i].seq = i;
+		}
+
+		threads[p] = CreateThread( NULL, 0, Producer::ThreadRoutine, &producers[p], 0, NULL );
+	}
+
+	InterlockedIncrement( &startFlag );
+
+	// number of nodes received from each producer, which is also the next expected sequence number
+	std::vector<int> received( TEST_PRODUCER_COUNT, 0 );
+	std::vector<char> seen( TEST_PRODUCER_COUNT * TEST_NODES_PER_PRODUCER, 0 );
+
+	const int totalCount = TEST_PRODUCER_COUNT * TEST_NODES_PER_PRODUCER;
+	int receivedCount = 0;
+	int batchCount = 0;
+
+	// the consumer drains the queue while the producers are still pushing
+	while ( receivedCount < totalCount )
+	{
+		LockFreeQueueNode *pNode = queue.PopAll();
+
+		if ( pNode )
+		{
+			batchCount++;
+		}
+
+		for ( ; pNode; pNode = pNode->pNext )
+		{
+			const TestNode *pTestNode = static_cast<TestNode*>( pNode );
+			const int p = pTestNode->producer;
+			const int index = p * TEST_NODES_PER_PRODUCER + pTestNode->seq;
+
+			TEST_CHECK( ! seen[index], "node %d of producer %d received twice", pTestNode->seq, p );
+			seen[index] = 1;
+
+			// nodes of one producer must keep their order
+			TEST_CHECK( pTestNode->seq == received[p], "producer %d: expected node %d, got %d", p, received[p],
+			  pTestNode->seq );
+			received[p] = pTestNode->seq + 1;
+
+			receivedCount++;
+		}
+
+		if ( g_testFailCount > 0 )
+		{
+			break;
+		}
+	}
+
+	for ( int p = 0; p < TEST_PRODUCER_COUNT; p++ )
+	{
+		WaitForSingleObject( threads[p], INFINITE );
+		CloseHandle( threads[p] );
+	}
+
+	TEST_CHECK( queue.PopAll() == NULL, "nodes left in the queue" );
+	TEST_CHECK( receivedCount == totalCount, "received %d of %d nodes", receivedCount, totalCount );
+
+	printf( "Received %d nodes in %d batches\n", receivedCount, batchCount );
+
+	TEST_MAIN_END();
+}
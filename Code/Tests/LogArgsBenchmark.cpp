@@ -0,0 +1,125 @@
+/**
+ * @file
+ * @brief Benchmark of the caller cost of deferred log formatting.
+ *
+ * Compares LogArgs::Capture, which is all the calling thread does when the message is formatted later, against
+ * vsnprintf_, which is what the caller would do otherwise. The time of LogArgs::Format is reported too, as it's paid
+ * by the thread that writes the log.
+ */
+
+#include <stdio.h>
+#include <time.h>
+
+// Library headers
+#include "printf/printf.h"
+
+// Launcher headers
+#include "LogArgs.h"
+
+#include "Test.h"
+
+#define BENCHMARK_ITERATIONS 2000000
+
+// same as LOG_DEFERRED_RECORD_SIZE
+#define BENCHMARK_RECORD_SIZE 2048
+
+extern "C" void _putchar( char c )  // required by the printf library
+{
+	putchar( c );
+}
+
+static volatile size_t g_sink;
+
+static double GetSeconds( clock_t start )
+{
+	return static_cast<double>( clock() - start ) / CLOCKS_PER_SEC;
+}
+
+static size_t CaptureV( unsigned char *record, const char *format, ... )
+{
+	va_list args;
+	va_start( args, format );
+	const size_t length = LogArgs::Capture( record, BENCHMARK_RECORD_SIZE, format, args );
+	va_end( args );
+
+	return length;
+}
+
+static int PrintV( char *buffer, const char *format, ... )
+{
+	va_list args;
+	va_start( args, format );
+	const int length = vsnprintf_( buffer, BENCHMARK_RECORD_SIZE, format, args );
+	va_end( args );
+
+	return length;
+}
+
+static void Report( const char *name, double captureTime, double printfTime, double formatTime )
+{
+	printf( "%-8s | Capture = %.3f s | vsnprintf_ = %.3f s | ratio = %.2f | Format = %.3f s\n",
+	  name, captureTime, printfTime, (captureTime > 0) ? printfTime / captureTime : 0, formatTime );
+}
+
+int main()
+{
+	static unsigned char record[BENCHMARK_RECORD_SIZE];
+	static char buffer[BENCHMARK_RECORD_SIZE];
+
+	TestRandom random( 11 );
+
+	// typical message of the game with a player name, an entity ID and a position
+	const char *typicalFormat = "Player %s (channel %d, entity %u) spawned at (%.2f, %.2f, %.2f)";
+
+	clock_t start = clock();
+	for ( int i = 0; i < BENCHMARK_ITERATIONS; i++ )
+	{
+		g_sink += CaptureV( record, typicalFormat, "Nomad", random.Next( 64 ), random.Next(),
+		  random.Next( 4096000 ) / 1000.0, random.Next( 4096000 ) / 1000.0, random.Next( 256000 ) / 1000.0 );
+	}
+	const double captureTypical = GetSeconds( start );
+
+	start = clock();
+	for ( int i = 0; i < BENCHMARK_ITERATIONS; i++ )
+	{
+		g_sink += PrintV( buffer, typicalFormat, "Nomad", random.Next( 64 ), random.Next(),
+		  random.Next( 4096000 ) / 1000.0, random.Next( 4096000 ) / 1000.0, random.Next( 256000 ) / 1000.0 );
+	}
+	const double printfTypical = GetSeconds( start );
+
+	start = clock();
+	for ( int i = 0; i < BENCHMARK_ITERATIONS; i++ )
+	{
+		g_sink += LogArgs::Format( record, buffer, sizeof buffer );
+	}
+	const double formatTypical = GetSeconds( start );
+
+	// messages with only integers and strings are cheap to format, so the gain is smaller
+	const char *simpleFormat = "$3[%s]$1 Loading %s (%d of %d)";
+
+	start = clock();
+	for ( int i = 0; i < BENCHMARK_ITERATIONS; i++ )
+	{
+		g_sink += CaptureV( record, simpleFormat, "Level", "Levels/Multiplayer/IA/Steelmill", random.Next( 100 ), 100 );
+	}
+	const double captureSimple = GetSeconds( start );
+
+	start = clock();
+	for ( int i = 0; i < BENCHMARK_ITERATIONS; i++ )
+	{
+		g_sink += PrintV( buffer, simpleFormat, "Level", "Levels/Multiplayer/IA/Steelmill", random.Next( 100 ), 100 );
+	}
+	const double printfSimple = GetSeconds( start );
+
+	start = clock();
+	for ( int i = 0; i < BENCHMARK_ITERATIONS; i++ )
+	{
+		g_sink += LogArgs::Format( record, buffer, sizeof buffer );
+	}
+	const double formatSimple = GetSeconds( start );
+
+	Report( "typical", captureTypical, printfTypical, formatTypical );
+	Report( "simple", captureSimple, printfSimple, formatSimple );
+
+	return 0;
+}
@@ -0,0 +1,225 @@
+/**
+ * @file
+ * @brief Equivalence test of deferred formatting by LogArgs against vsnprintf_.
+ */
+
+#include <string.h>
+#include <string>
+
+// Library headers
+#include "printf/printf.h"
+
+// Launcher headers
+#include "LogArgs.h"
+
+#include "Test.h"
+
+// same as LOG_DEFERRED_RECORD_SIZE
+#define TEST_RECORD_SIZE 2048
+
+int g_testFailCount = 0;
+
+extern "C" void _putchar( char c )  // required by the printf library
+{
+	putchar( c );
+}
+
+enum ECapture
+{
+	eC_Captured,  //!< The arguments must be captured.
+	eC_Fallback   //!< Capturing must fail, so the caller formats the message immediately.
+};
+
+/**
+ * @brief Formats the message both ways and compares the results.
+ * @param recordSize Size of the record. Smaller records are used to test overflow.
+ * @param nullString True if the only argument is a NULL string. vsnprintf_ crashes in that case, so an empty string
+ * is passed to it instead, which is how the captured NULL string is formatted.
+ */
+static void CheckV( ECapture expected, size_t recordSize, bool nullString, const char *format, va_list args )
+{
+	va_list argsCopy;
+	va_copy( argsCopy, args );
+
+	unsigned char record[TEST_RECORD_SIZE];
+	const size_t recordLength = LogArgs::Capture( record, recordSize, format, argsCopy );
+
+	va_end( argsCopy );
+
+	if ( expected == eC_Fallback )
+	{
+		TEST_CHECK( recordLength == 0, "\"%s\" captured, but it should fall back", format );
+		return;
+	}
+
+	TEST_CHECK( recordLength > 0, "\"%s\" not captured", format );
+	if ( recordLength == 0 )
+	{
+		return;
+	}
+
+	TEST_CHECK( recordLength <= recordSize, "\"%s\" used %u bytes of %u-byte record", format,
+	  static_cast<unsigned int>( recordLength ), static_cast<unsigned int>( recordSize ) );
+
+	char expectedBuffer[512];
+	int expectedLength;
+
+	if ( nullString )
+	{
+		// the only argument is the NULL string
+		expectedLength = snprintf_( expectedBuffer, sizeof expectedBuffer, format, "" );
+	}
+	else
+	{
+		expectedLength = vsnprintf_( expectedBuffer, sizeof expectedBuffer, format, args );
+	}
+
+	char result[512];
+	const size_t resultLength = LogArgs::Format( record, result, sizeof result );
+
+	TEST_CHECK( static_cast<int>( resultLength ) == expectedLength && strcmp( result, expectedBuffer ) == 0,
+	  "\"%s\": got \"%s\" (%u), expected \"%s\" (%d)", format, result, static_cast<unsigned int>( resultLength ),
+	  expectedBuffer, expectedLength );
+
+	// truncated output has the same length as the whole message and is null-terminated
+	for ( size_t bufferSize = 0; bufferSize < 8; bufferSize++ )
+	{
+		char truncated[8];
+		memset( truncated, '#', sizeof truncated );
+
+		const size_t truncatedLength = LogArgs::Format( record, (bufferSize > 0) ? truncated : NULL, bufferSize );
+
+		TEST_CHECK( truncatedLength == resultLength, "\"%s\": length %u with buffer of %u bytes", format,
+		  static_cast<unsigned int>( truncatedLength ), static_cast<unsigned int>( bufferSize ) );
+
+		if ( bufferSize > 0 )
+		{
+			const size_t expectedTruncatedLength = (resultLength < bufferSize) ? resultLength : bufferSize - 1;
+
+			TEST_CHECK( strncmp( truncated, result, expectedTruncatedLength ) == 0
+			  && truncated[expectedTruncatedLength] == '\0', "\"%s\": wrong output with buffer of %u bytes", format,
+			  static_cast<unsigned int>( bufferSize ) );
+		}
+	}
+}
+
+static void Check( const char *format, ... )
+{
+	va_list args;
+	va_start( args, format );
+	CheckV( eC_Captured, TEST_RECORD_SIZE, false, format, args );
+	va_end( args );
+}
+
+static void CheckFallback( size_t recordSize, const char *format, ... )
+{
+	va_list args;
+	va_start( args, format );
+	CheckV( eC_Fallback, recordSize, false, format, args );
+	va_end( args );
+}
+
+static void CheckNullString( const char *format, ... )
+{
+	va_list args;
+	va_start( args, format );
+	CheckV( eC_Captured, TEST_RECORD_SIZE, true, format, args );
+	va_end( args );
+}
+
+static void CheckFixedCases()
+{
+	Check( "" );
+	Check( "plain text" );
+	Check( "100%% done %%d" );
+	Check( "%d %i %u %x %X %o %c", -42, 42, 42u, 0xBEEFu, 0xBEEFu, 8u, 'c' );
+	Check( "[%5d] [%-5d] [%05d] [%+d] [% d]", 42, 42, 42, 42, 42 );
+	Check( "%hd %hhu", 70000, 300 );
+	Check( "%ld %lu", -123456789L, 123456789UL );
+	Check( "%lld %llu %llx", -9223372036854775807LL - 1, 18446744073709551615ULL, 0x123456789ABCDEFULL );
+	Check( "%zu %zd", static_cast<size_t>( -1 ), static_cast<size_t>( 12345 ) );
+	Check( "%p %p", static_cast<void*>( NULL ), static_cast<void*>( &g_testFailCount ) );
+	Check( "%f %.3f %10.2f %-10.1f| %e %g", 3.14159, -2.5, 1234.5678, 0.05, 12345.678, 0.0001 );
+
+	// strings
+	Check( "%s and %s", "first", "second" );
+	Check( "[%10s] [%-10s] [%.2s]", "right", "left", "truncated" );
+	Check( "[%*s] [%-*s]", 8, "star", 8, "star" );
+	Check( "[%*.*s]", 10, 3, "precision" );
+	Check( "[%*d] [%*d]", -6, 42, 6, 42 );
+	Check( "[%.*s]", -1, "negative precision" );
+	Check( "[%.*s]", 0, "zero precision" );
+	Check( "[%.*d]", 5, 42 );
+
+	// the string doesn't need to be null-terminated if the precision limits it
+	const char notTerminated[3] = { 'a', 'b', 'c' };
+	Check( "[%.3s]", notTerminated );
+	Check( "[%.*s]", 2, notTerminated );
+
+	CheckNullString( "[%s]", static_cast<const char*>( NULL ) );
+	CheckNullString( "[%5s]", static_cast<const char*>( NULL ) );
+
+	// the longest supported specifier has 31 characters
+	Check( "[%00000000000000000000000000010d]", 42 );
+}
+
+static void CheckFallbackCases()
+{
+	// 32 and more characters
+	CheckFallback( TEST_RECORD_SIZE, "[%000000000000000000000000000010d]", 42 );
+	CheckFallback( TEST_RECORD_SIZE, "[%-00000000000000000000000000000000000000000000010.5f]", 1.5 );
+
+	// incomplete specifier
+	CheckFallback( TEST_RECORD_SIZE, "trailing %" );
+	CheckFallback( TEST_RECORD_SIZE, "trailing %-5l" );
+
+	// record overflow by the format string, an argument or a string
+	std::string longString( 100, 'x' );
+	CheckFallback( 16, "this format string is too long" );
+	CheckFallback( 16, "%lld %lld", 1LL, 2LL );
+	CheckFallback( 64, "%s", longString.c_str() );
+	CheckFallback( 64, "%.80s", longString.c_str() );
+}
+
+static void CheckRandom()
+{
+	static const char *FLAGS[] = { "", "-", "0", "+", " ", "#", "-+" };
+	static const char *WIDTHS[] = { "", "1", "5", "12" };
+	static const char *PRECISIONS[] = { "", ".", ".0", ".3", ".9" };
+
+	static const char *STRINGS[] = { "", "a", "hello", "$3colored$$ text", "long string with spaces" };
+
+	TestRandom random( 42 );
+
+	for ( int i = 0; i < 100000; i++ )
+	{
+		std::string specs[4];
+
+		for ( int s = 0; s < 4; s++ )
+		{
+			specs[s] = "%";
+			specs[s] += FLAGS[random.Next( sizeof FLAGS / sizeof FLAGS[0] )];
+			specs[s] += WIDTHS[random.Next( sizeof WIDTHS / sizeof WIDTHS[0] )];
+			specs[s] += PRECISIONS[random.Next( sizeof PRECISIONS / sizeof PRECISIONS[0] )];
+		}
+
+		// the order of argument types is fixed
+		const std::string format = "i=" + specs[0] + "d ll=" + specs[1] + "llx f=" + specs[2] + "f s=" + specs[3] + "s";
+
+		const int intValue = static_cast<int>( random.Next() );
+		const long long longValue = (static_cast<long long>( random.Next() ) << 32) | random.Next();
+		const double doubleValue = (static_cast<int>( random.Next() ) / 1000.0) / (1 << random.Next( 16 ));
+		const char *stringValue = STRINGS[random.Next( sizeof STRINGS / sizeof STRINGS[0] )];
+
+		Check( format.c_str(), intValue, longValue, doubleValue, stringValue );
+	}
+}
+
+int main()
+{
+	CheckFixedCases();
+	CheckFallbackCases();
+	CheckRandom();
+
+	TEST_MAIN_END();
+}
@@ -0,0 +1,155 @@
+/**
+ * @file
+ * @brief Benchmark of LogSanitizer against the original per-byte loop on a sample of server log messages.
+ */
+
+#include <string>
+#include <vector>
+
+// Launcher headers
+#include "LogSanitizer.h"
+#include "StringBuffer.h"
+
+#include "Test.h"
+
+#define BENCHMARK_PASSES 500
+
+typedef StringBuffer<2048> LogBuffer;
+
+extern "C" void _putchar( char c )  // required by the printf library
+{
+	putchar( c );
+}
+
+static volatile size_t g_sink;
+
+/**
+ * @brief The original loop used by the log file before LogSanitizer was added.
+ */
+static void SanitizeOriginal( LogBuffer & tempBuffer, const LogBuffer & buffer )
+{
+	for ( size_t i = 0; i < buffer.getLength(); i++ )
+	{
+		if ( buffer[i] < 32 || buffer[i] == 127 )
+		{
+			// skip control characters
+		}
+		else if ( buffer[i] == '$' )
+		{
+			// convert "$$" to "$"
+			if ( buffer[i+1] == '$' )
+			{
+				tempBuffer.append( '$' );
+			}
+
+			// skip color codes
+			i++;
+		}
+		else
+		{
+			tempBuffer.append( buffer[i] );
+		}
+	}
+}
+
+static bool LoadMessages( const char *fileName, std::vector<std::string> & messages )
+{
+	FILE *file = fopen( fileName, "rb" );
+	if ( ! file )
+	{
+		return false;
+	}
+
+	std::string message;
+	int c;
+
+	while ( (c = fgetc( file )) != EOF )
+	{
+		if ( c == '\n' )
+		{
+			// the log adds new lines itself, but messages often contain the carriage return
+			messages.push_back( message );
+			message.clear();
+		}
+		else
+		{
+			message += static_cast<char>( c );
+		}
+	}
+
+	fclose( file );
+
+	return true;
+}
+
+template<class Func>
+static double Run( const std::vector<std::string> & messages, Func sanitize )
+{
+	const double startTime = TestGetSeconds();
+
+	for ( int pass = 0; pass < BENCHMARK_PASSES; pass++ )
+	{
+		for ( size_t i = 0; i < messages.size(); i++ )
+		{
+			// the message is always in a log buffer first
+			LogBuffer buffer;
+			buffer.append( messages[i].c_str() );
+
+			LogBuffer tempBuffer;
+			sanitize( tempBuffer, buffer );
+
+			g_sink += tempBuffer.getLength();
+		}
+	}
+
+	return TestGetSeconds() - startTime;
+}
+
+static void RunOriginal( LogBuffer & tempBuffer, const LogBuffer & buffer )
+{
+	SanitizeOriginal( tempBuffer, buffer );
+}
+
+static void RunScalar( LogBuffer & tempBuffer, const LogBuffer & buffer )
+{
+	char *text = tempBuffer.beginAppend( buffer.getLength() );
+	tempBuffer.endAppend( LogSanitizer::SanitizeScalar( text, buffer.get(), buffer.getLength(), true ) );
+}
+
+static void RunSSE2( LogBuffer & tempBuffer, const LogBuffer & buffer )
+{
+	char *text = tempBuffer.beginAppend( buffer.getLength() );
+	tempBuffer.endAppend( LogSanitizer::SanitizeSSE2( text, buffer.get(), buffer.getLength(), true ) );
+}
+
+int main( int argc, char **argv )
+{
+	const char *fileName = (argc > 1) ? argv[1] : TEST_DATA_DIR "/LogMessages.txt";
+
+	std::vector<std::string> messages;
+	if ( ! LoadMessages( fileName, messages ) )
+	{
+		fprintf( stderr, "Unable to open %s\n", fileName );
+		return 1;
+	}
+
+	size_t totalLength = 0;
+	for ( size_t i = 0; i < messages.size(); i++ )
+	{
+		totalLength += messages[i].length();
+	}
+
+	const double megabytes = static_cast<double>( totalLength ) * BENCHMARK_PASSES / (1024 * 1024);
+
+	const double originalTime = Run( messages, RunOriginal );
+	const double scalarTime = Run( messages, RunScalar );
+	const double sse2Time = Run( messages, RunSSE2 );
+
+	printf( "%u messages, %u bytes, %d passes\n", static_cast<unsigned int>( messages.size() ),
+	  static_cast<unsigned int>( totalLength ), BENCHMARK_PASSES );
+	printf( "Original loop | %.1f MB/s\n", megabytes / originalTime );
+	printf( "Scalar        | %.1f MB/s | ratio = %.2f\n", megabytes / scalarTime, originalTime / scalarTime );
+	printf( "SSE2          | %.1f MB/s | ratio = %.2f\n", megabytes / sse2Time, originalTime / sse2Time );
+
+	return 0;
+}
@@ -0,0 +1,139 @@
+/**
+ * @file
+ * @brief Equivalence test of LogSanitizer against the original per-byte loop.
+ */
+
+#include <string.h>
+#include <string>
+#include <vector>
+
+// Launcher headers
+#include "LogSanitizer.h"
+
+#include "Test.h"
+
+int g_testFailCount = 0;
+
+typedef size_t (*TSanitizeFunc)( char *dest, const char *src, size_t length, bool stripColorCodes );
+
+/**
+ * @brief The original loop used by the log before LogSanitizer was added.
+ * The message is null-terminated, so the character after the last "$" is always readable.
+ */
+static std::string SanitizeReference( const std::string & message, bool stripColorCodes )
+{
+	const char *buffer = message.c_str();
+	std::string result;
+
+	for ( size_t i = 0; i < message.length(); i++ )
+	{
+		if ( buffer[i] < 32 || buffer[i] == 127 )
+		{
+			// skip control characters
+		}
+		else if ( buffer[i] == '$' && stripColorCodes )
+		{
+			// convert "$$" to "$"
+			if ( buffer[i+1] == '$' )
+			{
+				result += '$';
+			}
+
+			// skip color codes
+			i++;
+		}
+		else
+		{
+			result += buffer[i];
+		}
+	}
+
+	return result;
+}
+
+static std::string RandomMessage( TestRandom & random )
+{
+	// mostly printable characters with runs of special ones, so both paths of each SSE2 block are used
+	static const char SPECIAL[] = { '$', '$', '\n', '\r', '\t', '\0', 127, -1, -128, '3' };
+
+	const size_t length = random.Next( 100 );
+	std::string message;
+
+	for ( size_t i = 0; i < length; i++ )
+	{
+		const unsigned int kind = random.Next( 8 );
+
+		if ( kind == 0 )
+		{
+			message += SPECIAL[random.Next( sizeof SPECIAL )];
+		}
+		else if ( kind == 1 )
+		{
+			message += static_cast<char>( random.Next( 256 ) );
+		}
+		else
+		{
+			message += static_cast<char>( ' ' + random.Next( 95 ) );
+		}
+	}
+
+	return message;
+}
+
+static void CheckMessage( TSanitizeFunc sanitize, const char *name, const std::string & message, bool stripColorCodes )
+{
+	const std::string expected = SanitizeReference( message, stripColorCodes );
+
+	// exactly as large as the source to catch writes beyond its end
+	std::vector<char> dest( message.length() + 1, '#' );
+	const size_t length = sanitize( &dest[0], message.data(), message.length(), stripColorCodes );
+
+	TEST_CHECK( length == expected.length() && memcmp( &dest[0], expected.data(), length ) == 0,
+	  "%s: wrong result of \"%s\" (%u bytes) with stripColorCodes = %d", name, message.c_str(),
+	  static_cast<unsigned int>( message.length() ), stripColorCodes );
+
+	TEST_CHECK( dest[message.length()] == '#', "%s: write beyond the end of the destination", name );
+}
+
+static void CheckFunction( TSanitizeFunc sanitize, const char *name )
+{
+	static const char *MESSAGES[] = {
+		"",
+		"$",
+		"$$",
+		"$$$",
+		"abc$",
+		"$3Level loaded$o",
+		"0123456789abcde$",
+		"0123456789abcdef$",
+		"0123456789abcdef$$",
+		"0123456789abcde$$x",
+		"Price is $$100 and $$$4colored",
+		"Line 1\nLine 2\r\n\tindented",
+	};
+
+	for ( size_t i = 0; i < sizeof MESSAGES / sizeof MESSAGES[0]; i++ )
+	{
+		CheckMessage( sanitize, name, MESSAGES[i], true );
+		CheckMessage( sanitize, name, MESSAGES[i], false );
+	}
+
+	TestRandom random( 12345 );
+
+	for ( int i = 0; i < 200000; i++ )
+	{
+		const std::string message = RandomMessage( random );
+
+		CheckMessage( sanitize, name, message, true );
+		CheckMessage( sanitize, name, message, false );
+	}
+}
+
+int main()
+{
+	CheckFunction( LogSanitizer::SanitizeScalar, "Scalar" );
+	CheckFunction( LogSanitizer::SanitizeSSE2, "SSE2" );
+	CheckFunction( LogSanitizer::Sanitize, "Sanitize" );
+
+	TEST_MAIN_END();
+}
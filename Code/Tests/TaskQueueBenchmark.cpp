@@ -0,0 +1,187 @@
+/**
+ * @file
+ * @brief Benchmark of the lock-free task queue against the original locked deque with concurrent producers.
+ */
+
+#include <deque>
+#include <vector>
+
+// Launcher headers
+#include "LockFreeQueue.h"
+
+#include "Test.h"
+
+#define BENCHMARK_TASKS_PER_PRODUCER 500000
+
+struct BenchmarkNode : public LockFreeQueueNode
+{
+	int value;
+};
+
+/**
+ * @brief The task queue used before LockFreeQueue: std::deque guarded by a critical section, popped one by one.
+ */
+class LockedQueue
+{
+	std::deque<BenchmarkNode*> m_queue;
+	CRITICAL_SECTION m_criticalSection;
+
+public:
+	LockedQueue()
+	: m_queue()
+	{
+		InitializeCriticalSection( &m_criticalSection );
+	}
+
+	~LockedQueue()
+	{
+		DeleteCriticalSection( &m_criticalSection );
+	}
+
+	void Push( BenchmarkNode *pNode )
+	{
+		EnterCriticalSection( &m_criticalSection );
+		m_queue.push_back( pNode );
+		LeaveCriticalSection( &m_criticalSection );
+	}
+
+	BenchmarkNode *Pop()
+	{
+		EnterCriticalSection( &m_criticalSection );
+
+		BenchmarkNode *pNode = NULL;
+
+		if ( ! m_queue.empty() )
+		{
+			pNode = m_queue.front();
+			m_queue.pop_front();
+		}
+
+		LeaveCriticalSection( &m_criticalSection );
+
+		return pNode;
+	}
+};
+
+template<class Queue>
+struct Producer
+{
+	Queue *pQueue;
+	BenchmarkNode *nodes;
+	volatile long *pStartFlag;
+
+	static DWORD WINAPI ThreadRoutine( void *param )
+	{
+		Producer *self = static_cast<Producer*>( param );
+
+		while ( ! *self->pStartFlag )
+		{
+		}
+
+		for ( int i = 0; i < BENCHMARK_TASKS_PER_PRODUCER; i++ )
+		{
+			self->pQueue->Push( &self->nodes[i] );
+		}
+
+		return 0;
+	}
+};
+
+static long long g_sink;
+
+static int Consume( LockedQueue & queue )
+{
+	int count = 0;
+
+	while ( BenchmarkNode *pNode = queue.Pop() )
+	{
+		g_sink += pNode->value;
+		count++;
+	}
+
+	return count;
+}
+
+static int Consume( LockFreeQueue & queue )
+{
+	int count = 0;
+
+	for ( LockFreeQueueNode *pNode = queue.PopAll(); pNode; pNode = pNode->pNext )
+	{
+		g_sink += static_cast<BenchmarkNode*>( pNode )->value;
+		count++;
+	}
+
+	return count;
+}
+
+/**
+ * @return Time in seconds until the consumer receives all tasks.
+ */
+template<class Queue>
+static double Run( int producerCount, std::vector<BenchmarkNode> & nodes )
+{
+	Queue queue;
+	volatile long startFlag = 0;
+
+	std::vector< Producer<Queue> > producers( producerCount );
+	std::vector<HANDLE> threads( producerCount );
+
+	for ( int p = 0; p < producerCount; p++ )
+	{
+		producers[p].pQueue = &queue;
+		producers[p].nodes = &nodes[p * BENCHMARK_TASKS_PER_PRODUCER];
+		producers[p].pStartFlag = &startFlag;
+
+		threads[p] = CreateThread( NULL, 0, Producer<Queue>::ThreadRoutine, &producers[p], 0, NULL );
+	}
+
+	const double startTime = TestGetSeconds();
+	InterlockedIncrement( &startFlag );
+
+	const int totalCount = producerCount * BENCHMARK_TASKS_PER_PRODUCER;
+	int receivedCount = 0;
+
+	// main thread drains the queue like once per frame, only much more often
+	while ( receivedCount < totalCount )
+	{
+		receivedCount += Consume( queue );
+	}
+
+	const double time = TestGetSeconds() - startTime;
+
+	for ( int p = 0; p < producerCount; p++ )
+	{
+		WaitForSingleObject( threads[p], INFINITE );
+		CloseHandle( threads[p] );
+	}
+
+	return time;
+}
+
+int main()
+{
+	static const int PRODUCER_COUNTS[] = { 1, 2, 4, 8 };
+
+	std::vector<BenchmarkNode> nodes( 8 * BENCHMARK_TASKS_PER_PRODUCER );
+
+	for ( size_t i = 0; i < nodes.size(); i++ )
+	{
+		nodes[i].value = static_cast<int>( i );
+	}
+
+	for ( size_t i = 0; i < sizeof PRODUCER_COUNTS / sizeof PRODUCER_COUNTS[0]; i++ )
+	{
+		const int producerCount = PRODUCER_COUNTS[i];
+		const double totalCount = producerCount * BENCHMARK_TASKS_PER_PRODUCER;
+
+		const double lockedTime = Run<LockedQueue>( producerCount, nodes );
+		const double lockFreeTime = Run<LockFreeQueue>( producerCount, nodes );
+
+		printf( "%d producers | locked deque = %.1f Mtasks/s | lock-free = %.1f Mtasks/s | ratio = %.2f\n",
+		  producerCount, totalCount / lockedTime / 1e6, totalCount / lockFreeTime / 1e6,
+		  (lockFreeTime > 0) ? lockedTime / lockFreeTime : 0 );
+	}
+
+	return 0;
+}
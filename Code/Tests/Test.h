@@ -0,0 +1,83 @@
+/**
+ * @file
+ * @brief Minimal test helpers.
+ */
+
+#pragma once
+
+#include <stdio.h>
+
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+
+extern int g_testFailCount;
+
+#define TEST_CHECK(condition, ...) \
+	do \
+	{ \
+		if ( ! (condition) ) \
+		{ \
+			fprintf( stderr, "%s:%d: Check failed: %s\n", __FILE__, __LINE__, #condition ); \
+			fprintf( stderr, __VA_ARGS__ ); \
+			fprintf( stderr, "\n" ); \
+			g_testFailCount++; \
+		} \
+	} \
+	while ( 0 )
+
+#define TEST_MAIN_END() \
+	do \
+	{ \
+		if ( g_testFailCount > 0 ) \
+		{ \
+			fprintf( stderr, "%d checks failed\n", g_testFailCount ); \
+			return 1; \
+		} \
+		printf( "All checks passed\n" ); \
+		return 0; \
+	} \
+	while ( 0 )
+
+/**
+ * @brief Simple deterministic random number generator, so failures are reproducible on any platform.
+ */
+class TestRandom
+{
+	unsigned int m_state;
+
+public:
+	explicit TestRandom( unsigned int seed )
+	: m_state(seed)
+	{
+	}
+
+	unsigned int Next()
+	{
+		// xorshift32
+		m_state ^= m_state << 13;
+		m_state ^= m_state >> 17;
+		m_state ^= m_state << 5;
+
+		return m_state;
+	}
+
+	unsigned int Next( unsigned int max )
+	{
+		return Next() % max;
+	}
+};
+
+/**
+ * @brief Wall-clock time for benchmarks.
+ * @return Seconds since some unspecified point.
+ */
+inline double TestGetSeconds()
+{
+	LARGE_INTEGER frequency;
+	LARGE_INTEGER counter;
+
+	QueryPerformanceFrequency( &frequency );
+	QueryPerformanceCounter( &counter );
+
+	return static_cast<double>( counter.QuadPart ) / frequency.QuadPart;
+}
@@ -0,0 +1,221 @@
+/**
+ * @file
+ * @brief Test of TimerWheel.
+ */
+
+#include <vector>
+
+// Launcher headers
+#include "TimerWheel.h"
+
+#include "Test.h"
+
+int g_testFailCount = 0;
+
+struct TaskRun
+{
+	int id;
+	unsigned long long tick;
+};
+
+static TimerWheel *g_pWheel;
+static unsigned long long g_currentTick;
+static std::vector<TaskRun> g_runs;
+static int g_destroyedCount;
+
+struct TestTask : public ILauncherTask
+{
+	int id;
+	unsigned int cancelHandle;  //!< Timer cancelled by this task or 0.
+	TestTask *pAddedTask;       //!< Task added by this task without delay or NULL.
+
+	explicit TestTask( int taskID )
+	: id(taskID),
+	  cancelHandle(0),
+	  pAddedTask(NULL)
+	{
+	}
+
+	~TestTask()
+	{
+		g_destroyedCount++;
+	}
+
+	void Run()
+	{
+		TaskRun run;
+		run.id = id;
+		run.tick = g_currentTick;
+
+		g_runs.push_back( run );
+
+		if ( cancelHandle )
+		{
+			g_pWheel->Cancel( cancelHandle );
+			cancelHandle = 0;
+		}
+
+		if ( pAddedTask )
+		{
+			g_pWheel->Add( pAddedTask, 0, 0 );
+			pAddedTask = NULL;
+		}
+	}
+};
+
+static void Reset( TimerWheel & wheel, unsigned long long startTick )
+{
+	g_pWheel = &wheel;
+	g_currentTick = startTick;
+	g_runs.clear();
+	g_destroyedCount = 0;
+
+	wheel.Init( startTick );
+}
+
+/**
+ * @brief Advances the wheel one tick at a time, so the tick of each execution is known.
+ * A timer expiring at tick N is executed when the wheel is advanced to tick N + 1.
+ */
+static void AdvanceTo( unsigned long long tick )
+{
+	while ( g_currentTick < tick )
+	{
+		g_pWheel->Advance( ++g_currentTick );
+	}
+}
+
+static int CountRuns( int id, unsigned long long tick )
+{
+	int count = 0;
+
+	for ( size_t i = 0; i < g_runs.size(); i++ )
+	{
+		if ( g_runs[i].id == id && g_runs[i].tick == tick )
+		{
+			count++;
+		}
+	}
+
+	return count;
+}
+
+static void CheckDelays()
+{
+	// both sides of each level boundary and beyond the range of the wheel
+	static const unsigned int DELAYS[] = { 0, 1, 255, 256, 16383, 16384, 1048575, 1048576, 100000000 };
+	const int count = sizeof DELAYS / sizeof DELAYS[0];
+
+	for ( unsigned long long start = 0; start < 1000; start += 777 )
+	{
+		TimerWheel wheel;
+		Reset( wheel, start );
+
+		for ( int i = 0; i < count; i++ )
+		{
+			wheel.Add( new TestTask( i ), DELAYS[i], 0 );
+		}
+
+		AdvanceTo( start + DELAYS[count-1] + 1 );
+
+		TEST_CHECK( static_cast<int>( g_runs.size() ) == count, "start %llu: %u tasks executed",
+		  start, static_cast<unsigned int>( g_runs.size() ) );
+
+		for ( int i = 0; i < count; i++ )
+		{
+			TEST_CHECK( CountRuns( i, start + DELAYS[i] + 1 ) == 1, "start %llu: delay %u executed at wrong tick",
+			  start, DELAYS[i] );
+		}
+
+		TEST_CHECK( wheel.GetActiveCount() == 0, "%u timers left", wheel.GetActiveCount() );
+		TEST_CHECK( g_destroyedCount == count, "%d tasks destroyed", g_destroyedCount );
+	}
+}
+
+static void CheckPeriodic()
+{
+	TimerWheel wheel;
+	Reset( wheel, 10 );
+
+	const unsigned int handle = wheel.Add( new TestTask( 0 ), 5, 300 );
+
+	AdvanceTo( 10 + 5 + 300 * 3 + 1 );
+
+	TEST_CHECK( g_runs.size() == 4, "periodic task executed %u times", static_cast<unsigned int>( g_runs.size() ) );
+
+	for ( int i = 0; i < 4; i++ )
+	{
+		TEST_CHECK( CountRuns( 0, 10 + 5 + 300 * i + 1 ) == 1, "periodic task not executed in period %d", i );
+	}
+
+	TEST_CHECK( wheel.Cancel( handle ), "periodic task not cancelled" );
+	TEST_CHECK( g_destroyedCount == 1, "cancelled task not destroyed" );
+	TEST_CHECK( ! wheel.Cancel( handle ), "stale handle accepted" );
+}
+
+/**
+ * @brief Timers expiring in the same tick cancel each other.
+ */
+static void CheckCancelInSameTick()
+{
+	for ( int periodicMask = 0; periodicMask < 4; periodicMask++ )
+	{
+		TimerWheel wheel;
+		Reset( wheel, 0 );
+
+		TestTask *pFirst = new TestTask( 1 );
+		TestTask *pSecond = new TestTask( 2 );
+
+		const unsigned int firstHandle = wheel.Add( pFirst, 100, (periodicMask & 1) ? 50 : 0 );
+		const unsigned int secondHandle = wheel.Add( pSecond, 100, (periodicMask & 2) ? 50 : 0 );
+
+		// whichever runs first cancels the other one
+		pFirst->cancelHandle = secondHandle;
+		pSecond->cancelHandle = firstHandle;
+
+		AdvanceTo( 101 );
+
+		TEST_CHECK( CountRuns( 1, 101 ) + CountRuns( 2, 101 ) == 1, "periodic mask %d: %u tasks executed",
+		  periodicMask, static_cast<unsigned int>( g_runs.size() ) );
+		TEST_CHECK( g_destroyedCount >= 1, "periodic mask %d: cancelled task not destroyed", periodicMask );
+
+		// the survivor continues if it's periodic
+		AdvanceTo( 1000 );
+
+		wheel.Cancel( firstHandle );
+		wheel.Cancel( secondHandle );
+
+		TEST_CHECK( wheel.GetActiveCount() == 0, "periodic mask %d: %u timers left", periodicMask, wheel.GetActiveCount() );
+		TEST_CHECK( g_destroyedCount == 2, "periodic mask %d: %d tasks destroyed", periodicMask, g_destroyedCount );
+	}
+}
+
+/**
+ * @brief A task executed by the wheel adds a timer without delay, which must be executed in the next tick.
+ */
+static void CheckAddFromTask()
+{
+	TimerWheel wheel;
+	Reset( wheel, 0 );
+
+	TestTask *pTask = new TestTask( 1 );
+	pTask->pAddedTask = new TestTask( 2 );
+
+	wheel.Add( pTask, 10, 0 );
+
+	AdvanceTo( 12 );
+
+	TEST_CHECK( CountRuns( 1, 11 ) == 1, "task not executed" );
+	TEST_CHECK( CountRuns( 2, 12 ) == 1, "task added without delay not executed in the next tick" );
+	TEST_CHECK( g_destroyedCount == 2, "%d tasks destroyed", g_destroyedCount );
+}
+
+int main()
+{
+	CheckDelays();
+	CheckPeriodic();
+	CheckCancelInSameTick();
+	CheckAddFromTask();
+
+	TEST_MAIN_END();
+}